@@ -0,0 +1,77 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace swizzle
+{
+    namespace detail
+    {
+        //! A minimal std::allocator replacement returning Alignment-aligned blocks, e.g. so that containers
+        //! can start at a cache line boundary. Alignment needs to be a power of two.
+        template <class T, size_t Alignment>
+        struct aligned_allocator
+        {
+            static_assert((Alignment & (Alignment - 1)) == 0, "Alignment needs to be a power of two");
+
+            typedef T value_type;
+
+            template <class U>
+            struct rebind
+            {
+                typedef aligned_allocator<U, Alignment> other;
+            };
+
+            aligned_allocator()
+            {}
+
+            template <class U>
+            aligned_allocator(const aligned_allocator<U, Alignment>&)
+            {}
+
+            //! Over-allocates and stores the original pointer just before the aligned block.
+            T* allocate(size_t count)
+            {
+                const size_t extra = Alignment + sizeof(void*);
+                if (count > (static_cast<size_t>(-1) - extra) / sizeof(T))
+                {
+                    throw std::bad_alloc();
+                }
+
+                void* raw = std::malloc(count * sizeof(T) + extra);
+                if (!raw)
+                {
+                    throw std::bad_alloc();
+                }
+
+                std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(raw) + extra) & ~static_cast<std::uintptr_t>(Alignment - 1);
+                reinterpret_cast<void**>(aligned)[-1] = raw;
+                return reinterpret_cast<T*>(aligned);
+            }
+
+            void deallocate(T* p, size_t)
+            {
+                if (p)
+                {
+                    std::free(reinterpret_cast<void**>(p)[-1]);
+                }
+            }
+
+            template <class U>
+            bool operator==(const aligned_allocator<U, Alignment>&) const
+            {
+                return true;
+            }
+
+            template <class U>
+            bool operator!=(const aligned_allocator<U, Alignment>&) const
+            {
+                return false;
+            }
+        };
+    }
+}
@@ -0,0 +1,470 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <utility>
+
+namespace swizzle
+{
+    namespace detail
+    {
+        //! Decoders of BCn (DXTn) 4x4 blocks, as stored in DDS and KTX files. Each one writes the 16 texels
+        //! of a block, row-major, as RGBA8 in packUnorm4x8 layout, i.e. R in the lowest byte.
+        namespace block_compression
+        {
+            inline std::uint32_t pack_rgba8(unsigned r, unsigned g, unsigned b, unsigned a)
+            {
+                return r | (g << 8) | (b << 16) | (a << 24);
+            }
+
+            //! Colour part of BC1, BC2 and BC3. Three colour mode, with transparent black as the fourth
+            //! entry, is only used by BC1 when c0 <= c1.
+            inline void decode_colour(const std::uint8_t* block, std::uint32_t* texels, bool allow_three_colour_mode)
+            {
+                const unsigned c0 = block[0] | (block[1] << 8);
+                const unsigned c1 = block[2] | (block[3] << 8);
+                const std::uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<std::uint32_t>(block[7]) << 24);
+
+                unsigned rgb[4][3];
+                const unsigned ends[2] = { c0, c1 };
+                for (int e = 0; e < 2; ++e)
+                {
+                    const unsigned r = (ends[e] >> 11) & 31, g = (ends[e] >> 5) & 63, b = ends[e] & 31;
+                    rgb[e][0] = (r << 3) | (r >> 2);
+                    rgb[e][1] = (g << 2) | (g >> 4);
+                    rgb[e][2] = (b << 3) | (b >> 2);
+                }
+
+                std::uint32_t palette[4];
+                palette[0] = pack_rgba8(rgb[0][0], rgb[0][1], rgb[0][2], 255);
+                palette[1] = pack_rgba8(rgb[1][0], rgb[1][1], rgb[1][2], 255);
+                if (c0 > c1 || !allow_three_colour_mode)
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        rgb[2][c] = (2 * rgb[0][c] + rgb[1][c] + 1) / 3;
+                        rgb[3][c] = (rgb[0][c] + 2 * rgb[1][c] + 1) / 3;
+                    }
+                    palette[2] = pack_rgba8(rgb[2][0], rgb[2][1], rgb[2][2], 255);
+                    palette[3] = pack_rgba8(rgb[3][0], rgb[3][1], rgb[3][2], 255);
+                }
+                else
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        rgb[2][c] = (rgb[0][c] + rgb[1][c] + 1) / 2;
+                    }
+                    palette[2] = pack_rgba8(rgb[2][0], rgb[2][1], rgb[2][2], 255);
+                    palette[3] = 0;
+                }
+
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    texels[i] = palette[(indices >> (2 * i)) & 3];
+                }
+            }
+
+            //! Single channel part of BC3, BC4 and BC5; values land in the given byte of texels, which
+            //! need to have it cleared beforehand.
+            inline void decode_channel(const std::uint8_t* block, std::uint32_t* texels, unsigned shift)
+            {
+                const unsigned v0 = block[0];
+                const unsigned v1 = block[1];
+
+                unsigned palette[8] = { v0, v1 };
+                if (v0 > v1)
+                {
+                    for (unsigned i = 1; i < 7; ++i)
+                    {
+                        palette[i + 1] = ((7 - i) * v0 + i * v1 + 3) / 7;
+                    }
+                }
+                else
+                {
+                    for (unsigned i = 1; i < 5; ++i)
+                    {
+                        palette[i + 1] = ((5 - i) * v0 + i * v1 + 2) / 5;
+                    }
+                    palette[6] = 0;
+                    palette[7] = 255;
+                }
+
+                std::uint64_t indices = 0;
+                for (int i = 0; i < 6; ++i)
+                {
+                    indices |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+                }
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    texels[i] |= palette[(indices >> (3 * i)) & 7] << shift;
+                }
+            }
+
+            //! 8 bytes: RGB with 1 bit alpha.
+            inline void decode_bc1(const std::uint8_t* block, std::uint32_t* texels)
+            {
+                decode_colour(block, texels, true);
+            }
+
+            //! 16 bytes: interpolated alpha, then a BC1 block for RGB.
+            inline void decode_bc3(const std::uint8_t* block, std::uint32_t* texels)
+            {
+                decode_colour(block + 8, texels, false);
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    texels[i] &= 0x00ffffffu;
+                }
+                decode_channel(block, texels, 24);
+            }
+
+            //! 8 bytes: R, decoded as (r, 0, 0, 1).
+            inline void decode_bc4(const std::uint8_t* block, std::uint32_t* texels)
+            {
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    texels[i] = 0xff000000u;
+                }
+                decode_channel(block, texels, 0);
+            }
+
+            //! 16 bytes: R, then G, decoded as (r, g, 0, 1).
+            inline void decode_bc5(const std::uint8_t* block, std::uint32_t* texels)
+            {
+                decode_bc4(block, texels);
+                decode_channel(block + 8, texels, 8);
+            }
+
+            //! Reads bits of a 16 byte block from the least significant bit of byte 0 onwards.
+            class bit_reader
+            {
+            public:
+                explicit bit_reader(const std::uint8_t* data)
+                    : m_low(0)
+                    , m_high(0)
+                    , m_position(0)
+                {
+                    for (int i = 7; i >= 0; --i)
+                    {
+                        m_low = (m_low << 8) | data[i];
+                        m_high = (m_high << 8) | data[8 + i];
+                    }
+                }
+
+                //! count <= 32
+                unsigned read(unsigned count)
+                {
+                    if (!count)
+                    {
+                        return 0;
+                    }
+
+                    std::uint64_t bits;
+                    if (m_position >= 64)
+                    {
+                        bits = m_high >> (m_position - 64);
+                    }
+                    else if (m_position == 0)
+                    {
+                        bits = m_low;
+                    }
+                    else
+                    {
+                        bits = (m_low >> m_position) | (m_high << (64 - m_position));
+                    }
+                    m_position += count;
+                    return static_cast<unsigned>(bits & ((std::uint64_t(1) << count) - 1));
+                }
+
+            private:
+                std::uint64_t m_low;
+                std::uint64_t m_high;
+                unsigned m_position;
+            };
+
+            //! Tables of the BC7 specification.
+            struct bc7_tables
+            {
+                //! Per mode: subsets, partition bits, rotation bits, index selection bits, colour bits,
+                //! alpha bits, per endpoint p-bits, shared p-bits, index bits, secondary index bits.
+                struct mode_info
+                {
+                    std::uint8_t subsets, partition_bits, rotation_bits, index_selection_bits, colour_bits, alpha_bits, endpoint_pbits, shared_pbits, index_bits, secondary_index_bits;
+                };
+
+                static const mode_info& mode(unsigned m)
+                {
+                    static const mode_info modes[8] = {
+                        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+                        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+                        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+                        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+                        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+                        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+                        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+                        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+                    };
+                    return modes[m];
+                }
+
+                //! Bit i is the subset of texel i.
+                static unsigned partition2(unsigned partition, unsigned texel)
+                {
+                    static const std::uint16_t table[64] = {
+                        0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80, 0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+                        0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce, 0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+                        0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a, 0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+                        0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c, 0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+                    };
+                    return (table[partition] >> texel) & 1u;
+                }
+
+                //! Two bits per texel, texel 0 in the lowest ones.
+                static unsigned partition3(unsigned partition, unsigned texel)
+                {
+                    static const std::uint32_t table[64] = {
+                        0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+                        0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+                        0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+                        0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+                        0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+                        0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+                        0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+                        0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+                    };
+                    return (table[partition] >> (2 * texel)) & 3u;
+                }
+
+                //! Index of the texel whose index has its top bit implied (0) in the given subset.
+                static unsigned anchor(unsigned subsets, unsigned partition, unsigned subset)
+                {
+                    static const std::uint8_t anchor2_1[64] = {
+                        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+                        15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+                        15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+                         6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+                    };
+                    static const std::uint8_t anchor3_1[64] = {
+                         3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+                         3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+                         8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+                         3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+                    };
+                    static const std::uint8_t anchor3_2[64] = {
+                        15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+                        15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+                        15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+                        15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+                    };
+                    if (subset == 0)
+                    {
+                        return 0;
+                    }
+                    if (subsets == 2)
+                    {
+                        return anchor2_1[partition];
+                    }
+                    return subset == 1 ? anchor3_1[partition] : anchor3_2[partition];
+                }
+
+                static const std::uint8_t* weights(unsigned bits)
+                {
+                    static const std::uint8_t weights2[4] = { 0, 21, 43, 64 };
+                    static const std::uint8_t weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+                    static const std::uint8_t weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+                    return bits == 2 ? weights2 : (bits == 3 ? weights3 : weights4);
+                }
+            };
+
+            //! 16 bytes: RGBA in one of eight modes. Reserved mode blocks decode to transparent black.
+            inline void decode_bc7(const std::uint8_t* block, std::uint32_t* texels)
+            {
+                unsigned mode_index = 0;
+                while (mode_index < 8 && !(block[0] & (1u << mode_index)))
+                {
+                    ++mode_index;
+                }
+                if (mode_index == 8)
+                {
+                    for (unsigned i = 0; i < 16; ++i)
+                    {
+                        texels[i] = 0;
+                    }
+                    return;
+                }
+
+                const bc7_tables::mode_info& mode = bc7_tables::mode(mode_index);
+                bit_reader bits(block);
+                bits.read(mode_index + 1);
+                const unsigned partition = bits.read(mode.partition_bits);
+                const unsigned rotation = bits.read(mode.rotation_bits);
+                const unsigned index_selection = bits.read(mode.index_selection_bits);
+
+                // RGBA of up to 3 pairs of endpoints
+                const unsigned endpoint_count = mode.subsets * 2;
+                unsigned endpoints[6][4];
+                for (unsigned c = 0; c < 3; ++c)
+                {
+                    for (unsigned e = 0; e < endpoint_count; ++e)
+                    {
+                        endpoints[e][c] = bits.read(mode.colour_bits);
+                    }
+                }
+                for (unsigned e = 0; e < endpoint_count; ++e)
+                {
+                    endpoints[e][3] = bits.read(mode.alpha_bits);
+                }
+
+                unsigned colour_bits = mode.colour_bits;
+                unsigned alpha_bits = mode.alpha_bits;
+                if (mode.endpoint_pbits || mode.shared_pbits)
+                {
+                    unsigned pbits[6];
+                    if (mode.endpoint_pbits)
+                    {
+                        for (unsigned e = 0; e < endpoint_count; ++e)
+                        {
+                            pbits[e] = bits.read(1);
+                        }
+                    }
+                    else
+                    {
+                        for (unsigned s = 0; s < mode.subsets; ++s)
+                        {
+                            pbits[2 * s] = pbits[2 * s + 1] = bits.read(1);
+                        }
+                    }
+                    for (unsigned e = 0; e < endpoint_count; ++e)
+                    {
+                        for (unsigned c = 0; c < 4; ++c)
+                        {
+                            endpoints[e][c] = (endpoints[e][c] << 1) | pbits[e];
+                        }
+                    }
+                    ++colour_bits;
+                    if (alpha_bits)
+                    {
+                        ++alpha_bits;
+                    }
+                }
+
+                // replicate the top bits into the missing low ones
+                for (unsigned e = 0; e < endpoint_count; ++e)
+                {
+                    for (unsigned c = 0; c < 4; ++c)
+                    {
+                        const unsigned count = c < 3 ? colour_bits : alpha_bits;
+                        if (!count)
+                        {
+                            endpoints[e][c] = 255;
+                            continue;
+                        }
+                        unsigned v = endpoints[e][c] << (8 - count);
+                        endpoints[e][c] = v | (v >> count);
+                    }
+                }
+
+                unsigned subsets[16];
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    subsets[i] = mode.subsets == 1 ? 0 : (mode.subsets == 2 ? bc7_tables::partition2(partition, i) : bc7_tables::partition3(partition, i));
+                }
+
+                unsigned indices[16];
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    const bool is_anchor = bc7_tables::anchor(mode.subsets, partition, subsets[i]) == i;
+                    indices[i] = bits.read(mode.index_bits - (is_anchor ? 1 : 0));
+                }
+                unsigned secondary_indices[16];
+                if (mode.secondary_index_bits)
+                {
+                    for (unsigned i = 0; i < 16; ++i)
+                    {
+                        secondary_indices[i] = bits.read(mode.secondary_index_bits - (i == 0 ? 1 : 0));
+                    }
+                }
+
+                const std::uint8_t* colour_weights = bc7_tables::weights(mode.index_bits);
+                const std::uint8_t* alpha_weights = colour_weights;
+                if (mode.secondary_index_bits && index_selection)
+                {
+                    colour_weights = bc7_tables::weights(mode.secondary_index_bits);
+                }
+                else if (mode.secondary_index_bits)
+                {
+                    alpha_weights = bc7_tables::weights(mode.secondary_index_bits);
+                }
+
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    const unsigned* e0 = endpoints[2 * subsets[i]];
+                    const unsigned* e1 = endpoints[2 * subsets[i] + 1];
+                    unsigned colour_index = indices[i];
+                    unsigned alpha_index = indices[i];
+                    if (mode.secondary_index_bits)
+                    {
+                        (index_selection ? colour_index : alpha_index) = secondary_indices[i];
+                    }
+
+                    unsigned rgba[4];
+                    for (unsigned c = 0; c < 4; ++c)
+                    {
+                        const unsigned w = c < 3 ? colour_weights[colour_index] : alpha_weights[alpha_index];
+                        rgba[c] = ((64 - w) * e0[c] + w * e1[c] + 32) >> 6;
+                    }
+                    if (rotation)
+                    {
+                        std::swap(rgba[3], rgba[rotation - 1]);
+                    }
+                    texels[i] = pack_rgba8(rgba[0], rgba[1], rgba[2], rgba[3]);
+                }
+            }
+        }
+
+        //! A direct-mapped cache of decoded 4x4 blocks, each one 64 bytes, i.e. a cache line. There is
+        //! one per thread, shared by all compressed textures, which tell their blocks apart with ids
+        //! from next_id(); 0 is never handed out, so zeroed tags never match. 64kB of texels hold more
+        //! than a row of blocks of a 2048 wide texture, which is what a scanline order walk needs; 256
+        //! slots thrashed there, 4096 no longer fitted L2.
+        struct decoded_block_cache
+        {
+            static const size_t slot_count = 1024;
+
+            //! id << 32 | block index
+            std::uint64_t tags[slot_count];
+            alignas(64) std::uint32_t texels[slot_count * 16];
+
+            static decoded_block_cache& get()
+            {
+                static thread_local decoded_block_cache cache;
+                return cache;
+            }
+
+            static std::uint32_t next_id()
+            {
+                static std::atomic<std::uint32_t> counter(0);
+                std::uint32_t id = ++counter;
+                // wrapped around, after 4 billion assignments
+                return id ? id : ++counter;
+            }
+
+            //! Index of the first texel of the block in texels; calls decode(block, texels) on a miss.
+            template <class Decoder>
+            std::uint32_t find(std::uint32_t id, std::uint32_t block, Decoder decode)
+            {
+                const std::uint64_t tag = (static_cast<std::uint64_t>(id) << 32) | block;
+                // consecutive blocks go to consecutive slots; textures start at different ones
+                const size_t slot = (block + id * 97u) & (slot_count - 1);
+                if (tags[slot] != tag)
+                {
+                    decode(block, &texels[slot * 16]);
+                    tags[slot] = tag;
+                }
+                return static_cast<std::uint32_t>(slot * 16);
+            }
+        };
+    }
+}
@@ -0,0 +1,750 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace swizzle
+{
+    namespace detail
+    {
+        //! Just enough of zlib (RFC 1950 / 1951) for PNG files: a streaming inflater, a small deflater and
+        //! the checksums both formats need.
+        namespace deflate
+        {
+            inline std::uint32_t adler32(std::uint32_t adler, const std::uint8_t* data, size_t size)
+            {
+                std::uint32_t a = adler & 0xffff;
+                std::uint32_t b = adler >> 16;
+                while (size)
+                {
+                    // 5552 is the most bytes that can be summed before b could overflow
+                    size_t n = size < 5552 ? size : 5552;
+                    size -= n;
+                    for (; n; --n)
+                    {
+                        a += *data++;
+                        b += a;
+                    }
+                    a %= 65521;
+                    b %= 65521;
+                }
+                return (b << 16) | a;
+            }
+
+            //! CRC-32 of PNG chunks (and zip, gzip...); start with 0.
+            inline std::uint32_t crc32(std::uint32_t crc, const std::uint8_t* data, size_t size)
+            {
+                struct table
+                {
+                    std::uint32_t entries[256];
+
+                    table()
+                    {
+                        for (std::uint32_t n = 0; n < 256; ++n)
+                        {
+                            std::uint32_t c = n;
+                            for (int k = 0; k < 8; ++k)
+                            {
+                                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                            }
+                            entries[n] = c;
+                        }
+                    }
+                };
+                static const table t;
+
+                crc = ~crc;
+                for (size_t i = 0; i < size; ++i)
+                {
+                    crc = t.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+                }
+                return ~crc;
+            }
+
+            //! Base values and extra bits of length (257 - 285) and distance (0 - 29) symbols.
+            struct symbol_tables
+            {
+                static const std::uint16_t* length_base()
+                {
+                    static const std::uint16_t values[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+                    return values;
+                }
+
+                static const std::uint8_t* length_extra()
+                {
+                    static const std::uint8_t values[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+                    return values;
+                }
+
+                static const std::uint16_t* distance_base()
+                {
+                    static const std::uint16_t values[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+                    return values;
+                }
+
+                static const std::uint8_t* distance_extra()
+                {
+                    static const std::uint8_t values[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+                    return values;
+                }
+            };
+
+            //! Canonical Huffman code; codes up to fast_bits long are decoded with a single lookup, longer
+            //! ones bit by bit with count and symbol, as in zlib's puff.
+            struct huffman_table
+            {
+                static const unsigned max_bits = 15;
+                static const unsigned fast_bits = 10;
+
+                //! symbol << 4 | length, 0 for codes longer than fast_bits
+                std::uint16_t fast[1 << fast_bits];
+                //! number of codes of each length
+                std::uint16_t count[max_bits + 1];
+                //! symbols ordered by code
+                std::uint16_t symbol[288];
+
+                //! false for over-subscribed codes; incomplete ones are fine (a single distance code is).
+                bool build(const std::uint8_t* lengths, unsigned n)
+                {
+                    std::memset(count, 0, sizeof(count));
+                    std::memset(fast, 0, sizeof(fast));
+                    for (unsigned i = 0; i < n; ++i)
+                    {
+                        ++count[lengths[i]];
+                    }
+                    count[0] = 0;
+
+                    int left = 1;
+                    for (unsigned len = 1; len <= max_bits; ++len)
+                    {
+                        left = (left << 1) - count[len];
+                        if (left < 0)
+                        {
+                            return false;
+                        }
+                    }
+
+                    std::uint16_t offsets[max_bits + 2];
+                    std::uint32_t next_code[max_bits + 2];
+                    offsets[1] = 0;
+                    next_code[1] = 0;
+                    for (unsigned len = 1; len <= max_bits; ++len)
+                    {
+                        offsets[len + 1] = offsets[len] + count[len];
+                        next_code[len + 1] = (next_code[len] + count[len]) << 1;
+                    }
+
+                    for (unsigned i = 0; i < n; ++i)
+                    {
+                        const unsigned len = lengths[i];
+                        if (!len)
+                        {
+                            continue;
+                        }
+                        symbol[offsets[len]++] = static_cast<std::uint16_t>(i);
+
+                        // codes are stored most significant bit first, so the lookup is by reversed code
+                        const std::uint32_t code = next_code[len]++;
+                        if (len <= fast_bits)
+                        {
+                            unsigned reversed = 0;
+                            for (unsigned b = 0; b < len; ++b)
+                            {
+                                reversed |= ((code >> b) & 1) << (len - 1 - b);
+                            }
+                            for (unsigned j = reversed; j < (1u << fast_bits); j += 1u << len)
+                            {
+                                fast[j] = static_cast<std::uint16_t>((i << 4) | len);
+                            }
+                        }
+                    }
+                    return true;
+                }
+            };
+
+            //! Decompresses a stream pulled from source, a functor size_t(std::uint8_t* buffer, size_t size)
+            //! returning 0 at the end, and pushes the output to sink, a functor void(const std::uint8_t*, size_t),
+            //! in pieces of at most window_size bytes. Memory use is constant: a 64kB ring for back references
+            //! and whatever has not been pushed yet.
+            template <class Source>
+            class inflater
+            {
+            public:
+                static const size_t window_size = 32768;
+
+                explicit inflater(Source& source)
+                    : m_source(source)
+                    , m_input_pos(0)
+                    , m_input_end(0)
+                    , m_padding(0)
+                    , m_bits(0)
+                    , m_bit_count(0)
+                    , m_out(0)
+                    , m_flushed(0)
+                    , m_ring(ring_size)
+                {}
+
+                //! A zlib stream: header, deflate data and Adler-32 of the output.
+                template <class Sink>
+                bool inflate_zlib(Sink& sink)
+                {
+                    const unsigned cmf = bits(8);
+                    const unsigned flg = bits(8);
+                    if ((cmf & 15) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 || (flg & 32))
+                    {
+                        return false;
+                    }
+
+                    std::uint32_t adler = 1;
+                    auto checked = [&](const std::uint8_t* data, size_t size) {
+                        adler = adler32(adler, data, size);
+                        sink(data, size);
+                    };
+                    if (!inflate(checked))
+                    {
+                        return false;
+                    }
+
+                    align();
+                    std::uint32_t expected = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        expected = (expected << 8) | bits(8);
+                    }
+                    return valid() && expected == adler;
+                }
+
+                //! Raw deflate data.
+                template <class Sink>
+                bool inflate(Sink& sink)
+                {
+                    bool last = false;
+                    while (!last)
+                    {
+                        last = bits(1) != 0;
+                        bool ok;
+                        switch (bits(2))
+                        {
+                        case 0:
+                            ok = stored(sink);
+                            break;
+                        case 1:
+                            ok = fixed(sink);
+                            break;
+                        case 2:
+                            ok = dynamic(sink);
+                            break;
+                        default:
+                            ok = false;
+                            break;
+                        }
+                        if (!ok || !valid())
+                        {
+                            return false;
+                        }
+                    }
+                    flush(sink);
+                    return true;
+                }
+
+            private:
+                static const size_t ring_size = 2 * window_size;
+                static const size_t input_size = 16384;
+
+                //! Past the end of input zeros are read, so that decoding needs no checks; more than a few
+                //! of them means a truncated stream.
+                bool valid() const
+                {
+                    return m_padding * 8 <= m_bit_count;
+                }
+
+                std::uint8_t next_byte()
+                {
+                    if (m_input_pos == m_input_end)
+                    {
+                        m_input_pos = 0;
+                        m_input_end = m_source(m_input, input_size);
+                        if (!m_input_end)
+                        {
+                            ++m_padding;
+                            return 0;
+                        }
+                    }
+                    return m_input[m_input_pos++];
+                }
+
+                void need(unsigned count)
+                {
+                    while (m_bit_count < count)
+                    {
+                        m_bits |= static_cast<std::uint64_t>(next_byte()) << m_bit_count;
+                        m_bit_count += 8;
+                    }
+                }
+
+                unsigned bits(unsigned count)
+                {
+                    need(count);
+                    const unsigned result = static_cast<unsigned>(m_bits & ((static_cast<std::uint64_t>(1) << count) - 1));
+                    m_bits >>= count;
+                    m_bit_count -= count;
+                    return result;
+                }
+
+                void align()
+                {
+                    bits(m_bit_count & 7);
+                }
+
+                //! -1 for invalid codes.
+                int decode(const huffman_table& table)
+                {
+                    need(huffman_table::max_bits);
+                    const unsigned entry = table.fast[m_bits & ((1u << huffman_table::fast_bits) - 1)];
+                    if (entry)
+                    {
+                        m_bits >>= entry & 15;
+                        m_bit_count -= entry & 15;
+                        return entry >> 4;
+                    }
+
+                    int code = 0;
+                    int first = 0;
+                    int index = 0;
+                    std::uint64_t peek = m_bits;
+                    for (unsigned len = 1; len <= huffman_table::max_bits; ++len)
+                    {
+                        code |= static_cast<int>(peek & 1);
+                        peek >>= 1;
+                        const int count = table.count[len];
+                        if (code - count < first)
+                        {
+                            m_bits >>= len;
+                            m_bit_count -= len;
+                            return table.symbol[index + (code - first)];
+                        }
+                        index += count;
+                        first += count;
+                        first <<= 1;
+                        code <<= 1;
+                    }
+                    return -1;
+                }
+
+                template <class Sink>
+                void put(std::uint8_t value, Sink& sink)
+                {
+                    m_ring[m_out++ & (ring_size - 1)] = value;
+                    if (m_out - m_flushed == window_size)
+                    {
+                        flush(sink);
+                    }
+                }
+
+                //! Pushes whatever has not been yet; at most window_size bytes, so one contiguous piece or two.
+                template <class Sink>
+                void flush(Sink& sink)
+                {
+                    while (m_flushed != m_out)
+                    {
+                        const size_t start = m_flushed & (ring_size - 1);
+                        const size_t size = std::min<size_t>(m_out - m_flushed, ring_size - start);
+                        sink(&m_ring[start], size);
+                        m_flushed += size;
+                    }
+                }
+
+                template <class Sink>
+                bool stored(Sink& sink)
+                {
+                    align();
+                    const unsigned len = bits(16);
+                    const unsigned nlen = bits(16);
+                    if (len != (~nlen & 0xffff))
+                    {
+                        return false;
+                    }
+                    for (unsigned i = 0; i < len && valid(); ++i)
+                    {
+                        put(static_cast<std::uint8_t>(bits(8)), sink);
+                    }
+                    return true;
+                }
+
+                template <class Sink>
+                bool fixed(Sink& sink)
+                {
+                    std::uint8_t lengths[288 + 30];
+                    std::memset(lengths, 8, 144);
+                    std::memset(lengths + 144, 9, 112);
+                    std::memset(lengths + 256, 7, 24);
+                    std::memset(lengths + 280, 8, 8);
+                    std::memset(lengths + 288, 5, 30);
+                    m_literals.build(lengths, 288);
+                    m_distances.build(lengths + 288, 30);
+                    return codes(sink);
+                }
+
+                template <class Sink>
+                bool dynamic(Sink& sink)
+                {
+                    static const std::uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+                    const unsigned literal_count = bits(5) + 257;
+                    const unsigned distance_count = bits(5) + 1;
+                    const unsigned length_count = bits(4) + 4;
+                    if (literal_count > 286 || distance_count > 30)
+                    {
+                        return false;
+                    }
+
+                    std::uint8_t lengths[288 + 32] = {};
+                    for (unsigned i = 0; i < length_count; ++i)
+                    {
+                        lengths[order[i]] = static_cast<std::uint8_t>(bits(3));
+                    }
+                    if (!m_literals.build(lengths, 19))
+                    {
+                        return false;
+                    }
+
+                    std::memset(lengths, 0, sizeof(lengths));
+                    for (unsigned i = 0; i < literal_count + distance_count && valid();)
+                    {
+                        const int symbol = decode(m_literals);
+                        if (symbol < 0)
+                        {
+                            return false;
+                        }
+                        if (symbol < 16)
+                        {
+                            lengths[i++] = static_cast<std::uint8_t>(symbol);
+                            continue;
+                        }
+
+                        std::uint8_t value = 0;
+                        unsigned repeat;
+                        if (symbol == 16)
+                        {
+                            if (i == 0)
+                            {
+                                return false;
+                            }
+                            value = lengths[i - 1];
+                            repeat = 3 + bits(2);
+                        }
+                        else if (symbol == 17)
+                        {
+                            repeat = 3 + bits(3);
+                        }
+                        else
+                        {
+                            repeat = 11 + bits(7);
+                        }
+                        if (i + repeat > literal_count + distance_count)
+                        {
+                            return false;
+                        }
+                        for (; repeat; --repeat)
+                        {
+                            lengths[i++] = value;
+                        }
+                    }
+
+                    // without an end of block code the block never ends
+                    if (!lengths[256])
+                    {
+                        return false;
+                    }
+
+                    // distance lengths go right after literal ones
+                    std::uint8_t distances[30];
+                    std::memcpy(distances, lengths + literal_count, distance_count);
+                    return m_literals.build(lengths, literal_count) && m_distances.build(distances, distance_count) && codes(sink);
+                }
+
+                template <class Sink>
+                bool codes(Sink& sink)
+                {
+                    while (valid())
+                    {
+                        const int symbol = decode(m_literals);
+                        if (symbol < 256)
+                        {
+                            if (symbol < 0)
+                            {
+                                return false;
+                            }
+                            put(static_cast<std::uint8_t>(symbol), sink);
+                            continue;
+                        }
+                        if (symbol == 256)
+                        {
+                            return true;
+                        }
+
+                        const unsigned l = static_cast<unsigned>(symbol) - 257;
+                        if (l >= 29)
+                        {
+                            return false;
+                        }
+                        const size_t length = symbol_tables::length_base()[l] + bits(symbol_tables::length_extra()[l]);
+
+                        const int d = decode(m_distances);
+                        if (d < 0 || d >= 30)
+                        {
+                            return false;
+                        }
+                        const size_t distance = symbol_tables::distance_base()[d] + bits(symbol_tables::distance_extra()[d]);
+                        if (distance > m_out)
+                        {
+                            return false;
+                        }
+
+                        // byte by byte, as the source may overlap what is being written
+                        for (size_t i = 0; i < length; ++i)
+                        {
+                            put(m_ring[(m_out - distance) & (ring_size - 1)], sink);
+                        }
+                    }
+                    return false;
+                }
+
+            private:
+                Source& m_source;
+                std::uint8_t m_input[input_size];
+                size_t m_input_pos;
+                size_t m_input_end;
+                size_t m_padding;
+                std::uint64_t m_bits;
+                unsigned m_bit_count;
+                //! Bytes output so far and pushed to the sink so far.
+                size_t m_out;
+                size_t m_flushed;
+                std::vector<std::uint8_t> m_ring;
+                huffman_table m_literals;
+                huffman_table m_distances;
+            };
+
+            //! Compresses into a zlib stream with fixed Huffman codes and greedy matching against a single
+            //! hash candidate, much like zlib's fastest level: a fraction of a real encoder's code for most
+            //! of its ratio on images. Output goes to sink, a functor void(const std::uint8_t*, size_t).
+            template <class Sink>
+            class deflater
+            {
+            public:
+                explicit deflater(Sink& sink)
+                    : m_sink(sink)
+                    , m_buffer(2 * window_size)
+                    , m_head(hash_size, 0)
+                    , m_base(0)
+                    , m_pos(0)
+                    , m_end(0)
+                    , m_adler(1)
+                    , m_bits(0)
+                    , m_bit_count(0)
+                    , m_output_size(0)
+                {
+                    // 32kB window, no dictionary, fastest level; then the one, never final, fixed block
+                    m_output[m_output_size++] = 0x78;
+                    m_output[m_output_size++] = 0x01;
+                    put_bits(2, 3);
+                }
+
+                void write(const std::uint8_t* data, size_t size)
+                {
+                    m_adler = adler32(m_adler, data, size);
+                    while (size)
+                    {
+                        if (m_end == m_buffer.size())
+                        {
+                            compress();
+                            // keep the window, drop the rest
+                            std::memmove(&m_buffer[0], &m_buffer[window_size], window_size);
+                            m_base += window_size;
+                            m_pos -= window_size;
+                            m_end -= window_size;
+                        }
+                        const size_t n = std::min(size, m_buffer.size() - m_end);
+                        std::memcpy(&m_buffer[m_end], data, n);
+                        m_end += n;
+                        data += n;
+                        size -= n;
+                    }
+                }
+
+                //! Ends the block, adds an empty final one and the checksum.
+                void finish()
+                {
+                    compress();
+                    put_symbol(256);
+                    put_bits(3, 3);
+                    put_symbol(256);
+                    if (m_bit_count & 7)
+                    {
+                        put_bits(0, 8 - (m_bit_count & 7));
+                    }
+                    for (int shift = 24; shift >= 0; shift -= 8)
+                    {
+                        put_bits((m_adler >> shift) & 0xff, 8);
+                    }
+                    flush_bits();
+                    m_sink(m_output, m_output_size);
+                    m_output_size = 0;
+                }
+
+            private:
+                static const size_t window_size = 32768;
+                static const unsigned hash_bits = 15;
+                static const size_t hash_size = static_cast<size_t>(1) << hash_bits;
+                static const size_t max_match = 258;
+
+                //! Everything buffered; matches do not look past m_end, so a few are shorter than they could be.
+                void compress()
+                {
+                    while (m_pos < m_end)
+                    {
+                        const size_t available = m_end - m_pos;
+                        if (available >= 3)
+                        {
+                            const std::uint8_t* p = &m_buffer[m_pos];
+                            const std::uint32_t position = static_cast<std::uint32_t>(m_base + m_pos);
+                            std::uint32_t& head = m_head[hash(p)];
+                            const std::uint32_t distance = position - head;
+                            head = position;
+
+                            if (distance > 0 && distance <= window_size && distance <= m_pos)
+                            {
+                                const std::uint8_t* q = p - distance;
+                                const size_t limit = available < max_match ? available : max_match;
+                                size_t length = 0;
+                                while (length < limit && p[length] == q[length])
+                                {
+                                    ++length;
+                                }
+                                if (length >= 3)
+                                {
+                                    put_match(length, distance);
+                                    // short matches are worth indexing, long ones are mostly runs
+                                    if (length <= 16 && available > length + 2)
+                                    {
+                                        for (size_t i = 1; i < length; ++i)
+                                        {
+                                            m_head[hash(p + i)] = position + static_cast<std::uint32_t>(i);
+                                        }
+                                    }
+                                    m_pos += length;
+                                    continue;
+                                }
+                            }
+                        }
+                        put_symbol(m_buffer[m_pos++]);
+                    }
+                }
+
+                static std::uint32_t hash(const std::uint8_t* p)
+                {
+                    const std::uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+                    return (v * 2654435761u) >> (32 - hash_bits);
+                }
+
+                void put_bits(std::uint32_t value, unsigned count)
+                {
+                    m_bits |= static_cast<std::uint64_t>(value) << m_bit_count;
+                    m_bit_count += count;
+                    if (m_bit_count >= 32)
+                    {
+                        flush_bits();
+                    }
+                }
+
+                void flush_bits()
+                {
+                    while (m_bit_count >= 8)
+                    {
+                        m_output[m_output_size++] = static_cast<std::uint8_t>(m_bits);
+                        m_bits >>= 8;
+                        m_bit_count -= 8;
+                    }
+                    if (m_output_size > sizeof(m_output) - 8)
+                    {
+                        m_sink(m_output, m_output_size);
+                        m_output_size = 0;
+                    }
+                }
+
+                //! Huffman codes go most significant bit first.
+                void put_code(std::uint32_t code, unsigned length)
+                {
+                    std::uint32_t reversed = 0;
+                    for (unsigned i = 0; i < length; ++i)
+                    {
+                        reversed |= ((code >> i) & 1) << (length - 1 - i);
+                    }
+                    put_bits(reversed, length);
+                }
+
+                //! Fixed literal/length code of RFC 1951, 3.2.6.
+                void put_symbol(unsigned symbol)
+                {
+                    if (symbol < 144)
+                    {
+                        put_code(0x30 + symbol, 8);
+                    }
+                    else if (symbol < 256)
+                    {
+                        put_code(0x190 + symbol - 144, 9);
+                    }
+                    else if (symbol < 280)
+                    {
+                        put_code(symbol - 256, 7);
+                    }
+                    else
+                    {
+                        put_code(0xc0 + symbol - 280, 8);
+                    }
+                }
+
+                void put_match(size_t length, size_t distance)
+                {
+                    unsigned l = 28;
+                    while (symbol_tables::length_base()[l] > length)
+                    {
+                        --l;
+                    }
+                    put_symbol(257 + l);
+                    put_bits(static_cast<std::uint32_t>(length - symbol_tables::length_base()[l]), symbol_tables::length_extra()[l]);
+
+                    unsigned d = 29;
+                    while (symbol_tables::distance_base()[d] > distance)
+                    {
+                        --d;
+                    }
+                    put_code(d, 5);
+                    put_bits(static_cast<std::uint32_t>(distance - symbol_tables::distance_base()[d]), symbol_tables::distance_extra()[d]);
+                }
+
+            private:
+                Sink& m_sink;
+                //! The window, then data not compressed yet.
+                std::vector<std::uint8_t> m_buffer;
+                //! Latest position of each hash, wrapping around after 4GB, which only costs a match.
+                std::vector<std::uint32_t> m_head;
+                //! Stream position of m_buffer[0].
+                size_t m_base;
+                size_t m_pos;
+                size_t m_end;
+                std::uint32_t m_adler;
+                std::uint64_t m_bits;
+                unsigned m_bit_count;
+                std::uint8_t m_output[4096];
+                size_t m_output_size;
+            };
+        }
+    }
+}
@@ -0,0 +1,65 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace swizzle
+{
+    namespace detail
+    {
+        //! Writes a whole file next to path (path + ".tmp.<pid>") and renames it over path only once
+        //! write(std::ostream&) has succeeded, so that path is never seen half written and processes
+        //! that have it mapped keep the old contents, instead of faulting on a truncated file. Returns
+        //! false, leaving path as it was, if anything failed. On Windows a file that is mapped can not
+        //! be replaced at all, which is reported as a failure too.
+        template <class Write>
+        bool replace_file(const char* path, Write write)
+        {
+#if defined(_WIN32)
+            const unsigned long pid = GetCurrentProcessId();
+#else
+            const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+            const std::string temporary = std::string(path) + ".tmp." + std::to_string(pid);
+            {
+                std::ofstream out(temporary.c_str(), std::ios::binary | std::ios::trunc);
+                if (out)
+                {
+                    write(static_cast<std::ostream&>(out));
+                    out.close();
+                }
+                if (out.fail())
+                {
+                    std::remove(temporary.c_str());
+                    return false;
+                }
+            }
+
+#if defined(_WIN32)
+            const bool replaced = MoveFileExA(temporary.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+            const bool replaced = std::rename(temporary.c_str(), path) == 0;
+#endif
+            if (!replaced)
+            {
+                std::remove(temporary.c_str());
+            }
+            return replaced;
+        }
+    }
+}
@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <swizzle/detail/utils.h>
+#include <swizzle/detail/vector_traits.h>
 
 #define CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_V(name) \
     static vector_type call_##name(vector_arg_type x) { return construct_static(functor_##name{}, x); }
@@ -47,6 +48,11 @@ namespace swizzle
                 typedef VectorType<bool, Size> bool_vector_type;
                 typedef ScalarType scalar_type;
                 typedef const ScalarType& scalar_arg_type;
+                typedef typename detail::get_int_scalar_type<ScalarType>::type int_scalar_type;
+                typedef VectorType<int_scalar_type, Size> int_vector_type;
+                typedef const int_vector_type& int_vector_arg_type;
+                typedef typename detail::get_uint_scalar_type<ScalarType>::type uint_scalar_type;
+                typedef typename detail::get_float_scalar_type<ScalarType>::type float_scalar_type;
 
             private:
 
@@ -383,6 +389,69 @@ namespace swizzle
                     }
                 };
 
+                struct functor_trunc
+                {
+                    template <size_t i> void operator()(vector_type& result, vector_arg_type x)
+                    {
+                        using namespace std;
+                        result.at(i) = trunc(x.at(i));
+                    }
+                };
+
+                struct functor_round
+                {
+                    template <size_t i> void operator()(vector_type& result, vector_arg_type x)
+                    {
+                        using namespace std;
+                        result.at(i) = round(x.at(i));
+                    }
+                };
+
+                struct functor_roundEven
+                {
+                    template <size_t i> void operator()(vector_type& result, vector_arg_type x)
+                    {
+                        using namespace std;
+                        result.at(i) = roundEven(x.at(i));
+                    }
+                };
+
+                struct functor_modf
+                {
+                    template <size_t i> void operator()(vector_type& result, vector_arg_type x, vector_type& integral)
+                    {
+                        using namespace std;
+                        result.at(i) = modf(x.at(i), &integral.at(i));
+                    }
+                };
+
+                struct functor_fma
+                {
+                    template <size_t i> void operator()(vector_type& result, vector_arg_type a, vector_arg_type b, vector_arg_type c)
+                    {
+                        using namespace std;
+                        result.at(i) = fma(a.at(i), b.at(i), c.at(i));
+                    }
+                };
+
+                struct functor_frexp
+                {
+                    template <size_t i> void operator()(vector_type& result, vector_arg_type x, int_vector_type& exp)
+                    {
+                        using namespace std;
+                        result.at(i) = frexp(x.at(i), &exp.at(i));
+                    }
+                };
+
+                struct functor_ldexp
+                {
+                    template <size_t i> void operator()(vector_type& result, vector_arg_type x, int_vector_arg_type exp)
+                    {
+                        using namespace std;
+                        result.at(i) = ldexp(x.at(i), exp.at(i));
+                    }
+                };
+
 
             public:
 
@@ -411,6 +480,9 @@ namespace swizzle
                 CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_V(fract)
                 CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_V(floor)
                 CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_V(ceil)
+                CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_V(trunc)
+                CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_V(round)
+                CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_V(roundEven)
                 CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_VV(mod)
                 CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_VS(mod)
 
@@ -428,6 +500,121 @@ namespace swizzle
                 CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_SV(step)
                 CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_VVV(smoothstep)
                 CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_SSV(smoothstep)
+                CXXSWIZZLE_DETAIL_SIMPLE_TRANSFORM_VVV(fma)
+
+                // these have out parameters; scalar overloads are needed for out parameters
+                // to bind with plain scalars
+
+                static vector_type call_modf(vector_arg_type x, vector_type& i)
+                {
+                    return construct_static(functor_modf{}, x, i);
+                }
+
+                static scalar_type call_modf(typename std::conditional<Size == 1, scalar_arg_type, not_available>::type x, scalar_type& i)
+                {
+                    using namespace std;
+                    return modf(x, &i);
+                }
+
+                static vector_type call_frexp(vector_arg_type x, int_vector_type& exp)
+                {
+                    return construct_static(functor_frexp{}, x, exp);
+                }
+
+                static scalar_type call_frexp(typename std::conditional<Size == 1, scalar_arg_type, not_available>::type x, int_scalar_type& exp)
+                {
+                    using namespace std;
+                    return frexp(x, &exp);
+                }
+
+                static vector_type call_ldexp(vector_arg_type x, int_vector_arg_type exp)
+                {
+                    return construct_static(functor_ldexp{}, x, exp);
+                }
+
+                static bool_vector_type call_isnan(vector_arg_type x)
+                {
+                    using namespace std;
+                    return construct<bool>([&](size_t i) -> bool { return isnan(x[i]); });
+                }
+
+                static bool_vector_type call_isinf(vector_arg_type x)
+                {
+                    using namespace std;
+                    return construct<bool>([&](size_t i) -> bool { return isinf(x[i]); });
+                }
+
+                // packing functions; these work on vec4/vec2 and uint, respectively
+
+                static uint_scalar_type call_packUnorm4x8(typename std::conditional<Size == 4, vector_arg_type, not_available>::type v)
+                {
+                    using namespace std;
+                    return packUnorm4x8(v.at(0), v.at(1), v.at(2), v.at(3));
+                }
+
+                static uint_scalar_type call_packSnorm4x8(typename std::conditional<Size == 4, vector_arg_type, not_available>::type v)
+                {
+                    using namespace std;
+                    return packSnorm4x8(v.at(0), v.at(1), v.at(2), v.at(3));
+                }
+
+                static uint_scalar_type call_packUnorm2x16(typename std::conditional<Size == 2, vector_arg_type, not_available>::type v)
+                {
+                    using namespace std;
+                    return packUnorm2x16(v.at(0), v.at(1));
+                }
+
+                static uint_scalar_type call_packSnorm2x16(typename std::conditional<Size == 2, vector_arg_type, not_available>::type v)
+                {
+                    using namespace std;
+                    return packSnorm2x16(v.at(0), v.at(1));
+                }
+
+                static uint_scalar_type call_packHalf2x16(typename std::conditional<Size == 2, vector_arg_type, not_available>::type v)
+                {
+                    using namespace std;
+                    return packHalf2x16(v.at(0), v.at(1));
+                }
+
+                static VectorType<float_scalar_type, 4> call_unpackUnorm4x8(typename std::conditional<Size == 1, scalar_arg_type, not_available>::type p)
+                {
+                    using namespace std;
+                    VectorType<float_scalar_type, 4> result;
+                    unpackUnorm4x8(p, &result.at(0), &result.at(1), &result.at(2), &result.at(3));
+                    return result;
+                }
+
+                static VectorType<float_scalar_type, 4> call_unpackSnorm4x8(typename std::conditional<Size == 1, scalar_arg_type, not_available>::type p)
+                {
+                    using namespace std;
+                    VectorType<float_scalar_type, 4> result;
+                    unpackSnorm4x8(p, &result.at(0), &result.at(1), &result.at(2), &result.at(3));
+                    return result;
+                }
+
+                static VectorType<float_scalar_type, 2> call_unpackUnorm2x16(typename std::conditional<Size == 1, scalar_arg_type, not_available>::type p)
+                {
+                    using namespace std;
+                    VectorType<float_scalar_type, 2> result;
+                    unpackUnorm2x16(p, &result.at(0), &result.at(1));
+                    return result;
+                }
+
+                static VectorType<float_scalar_type, 2> call_unpackSnorm2x16(typename std::conditional<Size == 1, scalar_arg_type, not_available>::type p)
+                {
+                    using namespace std;
+                    VectorType<float_scalar_type, 2> result;
+                    unpackSnorm2x16(p, &result.at(0), &result.at(1));
+                    return result;
+                }
+
+                static VectorType<float_scalar_type, 2> call_unpackHalf2x16(typename std::conditional<Size == 1, scalar_arg_type, not_available>::type p)
+                {
+                    using namespace std;
+                    VectorType<float_scalar_type, 2> result;
+                    unpackHalf2x16(p, &result.at(0), &result.at(1));
+                    return result;
+                }
 
                 // these are more complex
 
@@ -443,6 +630,23 @@ namespace swizzle
                     return i;
                 }
 
+                static vector_type call_refract(vector_arg_type I, vector_arg_type N, scalar_arg_type eta)
+                {
+                    using namespace std;
+                    scalar_type d = call_dot(N, I);
+                    scalar_type k = 1 - eta * eta * (1 - d * d);
+
+                    // no branches, so that SIMD lanes stay coherent: the result is zeroed
+                    // for total internal reflection (k < 0)
+                    scalar_type mask = 1 - step(k, scalar_arg_type(0));
+                    scalar_type factor = eta * d + sqrt(max(k, scalar_arg_type(0)));
+
+                    vector_type result = I * eta;
+                    result -= N * factor;
+                    result *= mask;
+                    return result;
+                }
+
                 // Geometric functions
                 static scalar_type call_length(vector_arg_type x)
                 {
@@ -0,0 +1,85 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+
+namespace swizzle
+{
+    namespace detail
+    {
+        //! Read-only memory, e.g. a mapped file, whose pages are brought in on first touch and can be
+        //! evicted by the owner when it runs over a budget. Readers call touch() with the offset of every
+        //! byte they are about to read; pages whose stamp is 0 are not resident, others carry the owner's
+        //! clock from their last touch, so the smallest stamps are the least recently used pages.
+        //! Evicted pages are re-read on the next access, so evicting a page that is being read is only
+        //! slow, never wrong. Kept free of platform headers; see glsl::texture_store.
+        class paged_memory
+        {
+        public:
+            static const unsigned page_shift = 16;
+            static const size_t page_size = static_cast<size_t>(1) << page_shift;
+
+            virtual ~paged_memory()
+            {}
+
+            const std::uint8_t* data() const
+            {
+                return m_data;
+            }
+
+            size_t size() const
+            {
+                return m_size;
+            }
+
+            size_t page_count() const
+            {
+                return (m_size + page_size - 1) >> page_shift;
+            }
+
+            //! Cheap when the page has been touched since the clock last moved: two relaxed loads.
+            void touch(size_t offset) const
+            {
+                const size_t page = offset >> page_shift;
+                const std::uint32_t now = m_clock->load(std::memory_order_relaxed);
+                if (m_stamps[page].load(std::memory_order_relaxed) != now)
+                {
+                    if (m_stamps[page].exchange(now, std::memory_order_relaxed) == 0)
+                    {
+                        fault(page);
+                    }
+                }
+            }
+
+        protected:
+            //! clock is never 0 and outlives this object.
+            paged_memory(const std::uint8_t* data, size_t size, const std::atomic<std::uint32_t>* clock)
+                : m_data(data)
+                , m_size(size)
+                , m_clock(clock)
+                , m_stamps(new std::atomic<std::uint32_t>[(size + page_size - 1) >> page_shift])
+            {
+                for (size_t i = 0; i < page_count(); ++i)
+                {
+                    m_stamps[i].store(0, std::memory_order_relaxed);
+                }
+            }
+
+            //! Called when a page that was not resident is touched.
+            virtual void fault(size_t page) const = 0;
+
+            const std::uint8_t* m_data;
+            size_t m_size;
+            const std::atomic<std::uint32_t>* m_clock;
+            std::unique_ptr<std::atomic<std::uint32_t>[]> m_stamps;
+
+        private:
+            paged_memory(const paged_memory&);
+            paged_memory& operator=(const paged_memory&);
+        };
+    }
+}
@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <swizzle/detail/utils.h>
+#include <swizzle/detail/vector_traits.h>
 
 namespace swizzle
 {
@@ -42,6 +43,12 @@ namespace swizzle
                 : data(data)
             {}
 
+            //! Conversion between wrappers of different types (like GLSL's float(uint)); explicit, as it may lose data.
+            template <typename OtherInternalType, typename OtherExternalType, typename OtherBoolType, typename OtherAssignPolicy>
+            explicit primitive_wrapper(const primitive_wrapper<OtherInternalType, OtherExternalType, OtherBoolType, OtherAssignPolicy>& other)
+                : data(static_cast<internal_type>(static_cast<OtherInternalType>(other)))
+            {}
+
             // functions
 
             inline friend this_type sin(this_arg x)
@@ -126,6 +133,117 @@ namespace swizzle
             {
                 return mod(x.data, y.data);
             }
+            inline friend this_type trunc(this_arg x)
+            {
+                return trunc(x.data);
+            }
+            inline friend this_type round(this_arg x)
+            {
+                return round(x.data);
+            }
+            inline friend this_type roundEven(this_arg x)
+            {
+                return roundEven(x.data);
+            }
+            inline friend this_type modf(this_arg x, this_type* i)
+            {
+                internal_type integral;
+                this_type result = modf(x.data, &integral);
+                *i = integral;
+                return result;
+            }
+            inline friend this_type fma(this_arg a, this_arg b, this_arg c)
+            {
+                return fma(a.data, b.data, c.data);
+            }
+
+            inline friend bool_type isnan(this_arg x)
+            {
+                return isnan(x.data);
+            }
+            inline friend bool_type isinf(this_arg x)
+            {
+                return isinf(x.data);
+            }
+
+            //! IntType is expected to be a primitive_wrapper too.
+            template <typename IntType>
+            inline friend this_type frexp(this_arg x, IntType* e)
+            {
+                typename IntType::internal_type exponent;
+                this_type result = frexp(x.data, &exponent);
+                *e = exponent;
+                return result;
+            }
+            template <typename IntType>
+            inline friend this_type ldexp(this_arg x, const IntType& e)
+            {
+                return ldexp(x.data, static_cast<typename IntType::internal_type>(e));
+            }
+
+            //! Packing functions; the result is an unsigned wrapper, as found by get_uint_scalar_type.
+            template <typename UIntType = typename get_uint_scalar_type<primitive_wrapper>::type>
+            inline friend UIntType packUnorm4x8(this_arg x, this_arg y, this_arg z, this_arg w)
+            {
+                return packUnorm4x8(x.data, y.data, z.data, w.data);
+            }
+            template <typename UIntType = typename get_uint_scalar_type<primitive_wrapper>::type>
+            inline friend UIntType packSnorm4x8(this_arg x, this_arg y, this_arg z, this_arg w)
+            {
+                return packSnorm4x8(x.data, y.data, z.data, w.data);
+            }
+            template <typename UIntType = typename get_uint_scalar_type<primitive_wrapper>::type>
+            inline friend UIntType packUnorm2x16(this_arg x, this_arg y)
+            {
+                return packUnorm2x16(x.data, y.data);
+            }
+            template <typename UIntType = typename get_uint_scalar_type<primitive_wrapper>::type>
+            inline friend UIntType packSnorm2x16(this_arg x, this_arg y)
+            {
+                return packSnorm2x16(x.data, y.data);
+            }
+            template <typename UIntType = typename get_uint_scalar_type<primitive_wrapper>::type>
+            inline friend UIntType packHalf2x16(this_arg x, this_arg y)
+            {
+                return packHalf2x16(x.data, y.data);
+            }
+
+            //! Unpacking functions; FloatType is expected to be a primitive_wrapper too.
+            template <typename FloatType>
+            inline friend void unpackUnorm4x8(this_arg p, FloatType* x, FloatType* y, FloatType* z, FloatType* w)
+            {
+                typename FloatType::internal_type rx, ry, rz, rw;
+                unpackUnorm4x8(p.data, &rx, &ry, &rz, &rw);
+                *x = rx; *y = ry; *z = rz; *w = rw;
+            }
+            template <typename FloatType>
+            inline friend void unpackSnorm4x8(this_arg p, FloatType* x, FloatType* y, FloatType* z, FloatType* w)
+            {
+                typename FloatType::internal_type rx, ry, rz, rw;
+                unpackSnorm4x8(p.data, &rx, &ry, &rz, &rw);
+                *x = rx; *y = ry; *z = rz; *w = rw;
+            }
+            template <typename FloatType>
+            inline friend void unpackUnorm2x16(this_arg p, FloatType* x, FloatType* y)
+            {
+                typename FloatType::internal_type rx, ry;
+                unpackUnorm2x16(p.data, &rx, &ry);
+                *x = rx; *y = ry;
+            }
+            template <typename FloatType>
+            inline friend void unpackSnorm2x16(this_arg p, FloatType* x, FloatType* y)
+            {
+                typename FloatType::internal_type rx, ry;
+                unpackSnorm2x16(p.data, &rx, &ry);
+                *x = rx; *y = ry;
+            }
+            template <typename FloatType>
+            inline friend void unpackHalf2x16(this_arg p, FloatType* x, FloatType* y)
+            {
+                typename FloatType::internal_type rx, ry;
+                unpackHalf2x16(p.data, &rx, &ry);
+                *x = rx; *y = ry;
+            }
 
             inline friend this_type min(this_arg x, this_arg y)
             {
@@ -182,6 +300,29 @@ namespace swizzle
                 return *this = *this / other;
             }
 
+            // bitwise compound operators; make sense for integer types only
+
+            this_type& operator&=(this_arg other)
+            {
+                return *this = *this & other;
+            }
+            this_type& operator|=(this_arg other)
+            {
+                return *this = *this | other;
+            }
+            this_type& operator^=(this_arg other)
+            {
+                return *this = *this ^ other;
+            }
+            this_type& operator<<=(int shift)
+            {
+                return *this = *this << shift;
+            }
+            this_type& operator>>=(int shift)
+            {
+                return *this = *this >> shift;
+            }
+
             // binary operators
 
             inline friend this_type operator+(this_arg a, this_arg b)
@@ -234,6 +375,41 @@ namespace swizzle
                 return internal_type(a) / b.data;
             }
 
+            // bitwise operators; make sense for integer types only
+
+            inline friend this_type operator&(this_arg a, this_arg b)
+            {
+                return a.data & b.data;
+            }
+            inline friend this_type operator|(this_arg a, this_arg b)
+            {
+                return a.data | b.data;
+            }
+            inline friend this_type operator^(this_arg a, this_arg b)
+            {
+                return a.data ^ b.data;
+            }
+            inline friend this_type operator&(this_arg a, external_type_arg b)
+            {
+                return a.data & internal_type(b);
+            }
+            inline friend this_type operator|(this_arg a, external_type_arg b)
+            {
+                return a.data | internal_type(b);
+            }
+            inline friend this_type operator^(this_arg a, external_type_arg b)
+            {
+                return a.data ^ internal_type(b);
+            }
+            inline friend this_type operator<<(this_arg a, int shift)
+            {
+                return a.data << shift;
+            }
+            inline friend this_type operator>>(this_arg a, int shift)
+            {
+                return a.data >> shift;
+            }
+
             // casts
 
             //! To avoid ADL-hell, cast is explict.
@@ -15,6 +15,49 @@ namespace swizzle
         struct get_vector_type_impl
         {};
 
+        //! Type to specialise; it should define a nested type 'type' being an integer scalar with the same
+        //! number of components as T (GLSL's genIType counterpart of genType). Non-specialised version
+        //! yields operation_not_available, disabling functions relying on it.
+        template <class T>
+        struct get_int_scalar_type
+        {
+            typedef operation_not_available type;
+        };
+
+        //! As above, but for unsigned integers (GLSL's genUType); used by packing functions.
+        template <class T>
+        struct get_uint_scalar_type
+        {
+            typedef operation_not_available type;
+        };
+
+        //! The other way round: a floating point scalar with the same number of components as T. Used by
+        //! unpacking functions.
+        template <class T>
+        struct get_float_scalar_type
+        {
+            typedef operation_not_available type;
+        };
+
+        //! Type to specialise; describes how lanes of FloatType are moved from and to arrays of floats
+        //! by batched functions (see glsl/batch_transform.h). Expected members:
+        //! - size: number of lanes; alignment: in bytes, required by stream
+        //! - FloatType load(const float* p): lanes are p[0], p[1], ...
+        //! - store(v, float* p): the other way round
+        //! - load_interleaved(const float* p, FloatType (&v)[N]): lanes of v[c] are p[c], p[N + c], ...;
+        //!   N is 3 or 4, and for 3 it may read one float past the last element
+        //! - store_interleaved(const FloatType (&v)[N], float* p): the other way round
+        //! - stream(v, float* p): non-temporal store, p aligned; stream_fence() once done streaming
+        //! - uint_type gather(const std::uint32_t* p, const uint_type& index): lanes are p[index[0]], ...;
+        //!   uint_type is get_uint_scalar_type<FloatType>::type. Used by samplers (see glsl/texture_sampler.h)
+        //! - FloatType gather(const float* p, const uint_type& index): as above
+        //! - uint_type load(const std::uint32_t* p), store(const uint_type& v, std::uint32_t* p): as load
+        //!   and store, for lanes that need to be processed one by one
+        //! Non-specialised version is empty, failing any function relying on it.
+        template <class FloatType>
+        struct batch_traits
+        {};
+
         //! Used for graceful SFINAE - becomes true_type if get_vector_type_impl defines nested type.
         template <class T>
         struct has_vector_type_impl : std::integral_constant<bool, has_type< get_vector_type_impl< typename remove_reference_cv<T>::type > >::value >
@@ -61,12 +104,21 @@ namespace swizzle
 
 
 
+        template <class T, class... U>
+        struct get_vector_type;
+
+        //! Only instantiated once T is known to be a vector, so that types without get_vector_type_impl
+        //! (e.g. quaternions) fail softly and overloads taking them can be chosen instead.
+        template <class T, class... U>
+        struct get_common_vector_type : common_vector_type< typename get_vector_type<T>::type, typename get_vector_type<U...>::type >
+        {};
+
         //! Defines common vector type for given combination of input types.Scalars are treated as one-component vector.
         template <class T, class... U>
         struct get_vector_type
             : std::conditional<
                 has_vector_type_impl<T>::value,
-                common_vector_type< typename get_vector_type<T>::type, typename get_vector_type<U...>::type >,
+                get_common_vector_type<T, U...>,
                 nothing
             >::type
         {};
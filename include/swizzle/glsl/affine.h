@@ -0,0 +1,172 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <swizzle/detail/utils.h>
+#include <swizzle/glsl/matrix.h>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! An affine transform, i.e. a 4x4 matrix with the last row being (0, 0, 0, 1). Only the top 3x4
+        //! part is stored (3x3 linear part and translation column), so transforming a point takes 9
+        //! multiply-adds and 3 adds instead of 16 multiply-adds, and composing two transforms is 36
+        //! multiply-adds instead of 64.
+        template <template <class, size_t> class VectorType, class ScalarType>
+        class affine3
+        {
+        public:
+            typedef ScalarType scalar_type;
+            typedef VectorType<ScalarType, 3> vec3_type;
+            typedef VectorType<ScalarType, 4> vec4_type;
+            typedef matrix<VectorType, ScalarType, 3, 3> mat3_type;
+            typedef matrix<VectorType, ScalarType, 4, 4> mat4_type;
+
+        // CONSTRUCTION
+        public:
+
+            //! Identity.
+            affine3()
+                : m_data(scalar_type(1))
+            {}
+
+            affine3(const mat3_type& linear, const vec3_type& translation)
+            {
+                detail::static_for<0, 3>([&](size_t col) -> void { m_data[col] = linear[col]; });
+                m_data[3] = translation;
+            }
+
+            //! Drops the last row; it is not checked whether it is (0, 0, 0, 1).
+            explicit affine3(const mat4_type& m)
+            {
+                detail::static_for<0, 4>([&](size_t col) -> void
+                {
+                    for (size_t row = 0; row < 3; ++row)
+                    {
+                        m_data[col][row] = m[col][row];
+                    }
+                });
+            }
+
+        // UTILITY FUNCTIONS
+        public:
+
+            //! \return Column; 0-2 are the linear part, 3 is the translation
+            const vec3_type& column(size_t i) const
+            {
+                return m_data[i];
+            }
+
+            //! \return Column; 0-2 are the linear part, 3 is the translation
+            vec3_type& column(size_t i)
+            {
+                return m_data[i];
+            }
+
+            mat3_type linear() const
+            {
+                mat3_type result;
+                detail::static_for<0, 3>([&](size_t col) -> void { result[col] = m_data[col]; });
+                return result;
+            }
+
+            const vec3_type& translation() const
+            {
+                return m_data[3];
+            }
+
+            mat4_type to_mat4() const
+            {
+                mat4_type result;
+                detail::static_for<0, 4>([&](size_t col) -> void
+                {
+                    for (size_t row = 0; row < 3; ++row)
+                    {
+                        result[col][row] = m_data[col][row];
+                    }
+                });
+                result[3][3] = scalar_type(1);
+                return result;
+            }
+
+            //! Transforms a point (w == 1).
+            vec3_type transform_point(const vec3_type& p) const
+            {
+                vec3_type result = m_data[3];
+                detail::static_for<0, 3>([&](size_t col) -> void
+                {
+                    result += m_data[col] * p[col];
+                });
+                return result;
+            }
+
+            //! Transforms a direction (w == 0), i.e. translation is ignored.
+            vec3_type transform_direction(const vec3_type& d) const
+            {
+                vec3_type result = m_data[0] * d[0];
+                detail::static_for<1, 3>([&](size_t col) -> void
+                {
+                    result += m_data[col] * d[col];
+                });
+                return result;
+            }
+
+        // OPERATORS
+        public:
+
+            //! Composition; the result applies b first, then a (same as mat4 multiplication).
+            friend affine3 operator*(const affine3& a, const affine3& b)
+            {
+                affine3 result;
+                detail::static_for<0, 3>([&](size_t col) -> void
+                {
+                    result.m_data[col] = a.transform_direction(b.m_data[col]);
+                });
+                result.m_data[3] = a.transform_point(b.m_data[3]);
+                return result;
+            }
+
+            affine3& operator*=(const affine3& other)
+            {
+                return *this = *this * other;
+            }
+
+            //! Same as to_mat4() * v, without the implicit row.
+            friend vec4_type operator*(const affine3& a, const vec4_type& v)
+            {
+                vec3_type xyz = a.transform_direction(vec3_type(v[0], v[1], v[2]));
+                xyz += a.m_data[3] * v[3];
+                return vec4_type(xyz[0], xyz[1], xyz[2], v[3]);
+            }
+
+            bool operator==(const affine3& o) const
+            {
+                bool are_equal = true;
+                detail::static_for<0, 4>([&](size_t i) -> void { are_equal &= (m_data[i] == o.m_data[i]); });
+                return are_equal;
+            }
+
+            bool operator!=(const affine3& o) const
+            {
+                return !(*this == o);
+            }
+
+        // GLSL FUNCTIONS
+        public:
+
+            //! Inverse of the linear part and a back-rotated, negated translation; cheaper than mat4's inverse.
+            friend affine3 inverse(const affine3& a)
+            {
+                mat3_type linear = inverse(a.linear());
+                affine3 result(linear, vec3_type());
+                result.m_data[3] = -result.transform_direction(a.m_data[3]);
+                return result;
+            }
+
+        private:
+            //! 3 rows, 4 columns
+            matrix<VectorType, ScalarType, 3, 4> m_data;
+        };
+    }
+}
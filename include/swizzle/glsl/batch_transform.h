@@ -0,0 +1,295 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <swizzle/detail/vector_traits.h>
+#include <swizzle/detail/utils.h>
+#include <swizzle/glsl/scalar_support.h>
+#include <swizzle/glsl/vector.h>
+#include <swizzle/glsl/matrix.h>
+
+//! Element count from which batched transforms run multithreaded (if compiled with OpenMP)
+//! and use non-temporal stores for aligned outputs, which are not going to stay in cache anyway.
+#ifndef CXXSWIZZLE_BATCH_LARGE_THRESHOLD
+#define CXXSWIZZLE_BATCH_LARGE_THRESHOLD 65536
+#endif
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! Structure of arrays view: i-th element is (x[i], y[i], z[i]).
+        template <class T>
+        struct soa3_span
+        {
+            T* x;
+            T* y;
+            T* z;
+        };
+
+        namespace batch_detail
+        {
+            typedef matrix<vector, float, 4, 4> mat4_type;
+            typedef matrix<vector, float, 3, 3> mat3_type;
+
+            //! What the w of an input element is.
+            enum w_source
+            {
+                w_zero,
+                w_one,
+                w_read
+            };
+
+            template <class FloatType>
+            matrix<vector, FloatType, 4, 4> broadcast(const mat4_type& m)
+            {
+                matrix<vector, FloatType, 4, 4> result;
+                detail::static_for<0, 4>([&](size_t col) -> void
+                {
+                    for (size_t row = 0; row < 4; ++row)
+                    {
+                        result[col][row] = FloatType(m[col][row]);
+                    }
+                });
+                return result;
+            }
+
+            //! First OutSize rows of m * (in, w); known w's are not multiplied, in[3] is only read for w_read.
+            template <w_source W, class FloatType, size_t OutSize>
+            inline void transform(const matrix<vector, FloatType, 4, 4>& m, const FloatType* in, FloatType (&out)[OutSize])
+            {
+                for (size_t row = 0; row < OutSize; ++row)
+                {
+                    FloatType r = m[0][row] * in[0];
+                    r += m[1][row] * in[1];
+                    r += m[2][row] * in[2];
+                    if (W == w_one)
+                    {
+                        r += m[3][row];
+                    }
+                    else if (W == w_read)
+                    {
+                        r += m[3][row] * in[3];
+                    }
+                    out[row] = r;
+                }
+            }
+
+            //! Interleaved vectors; a step reads and writes batch_traits::size whole vectors.
+            template <w_source W, size_t InSize, size_t OutSize>
+            struct aos_step
+            {
+                const float* in;
+                float* out;
+
+                bool is_output_aligned(size_t alignment) const
+                {
+                    return reinterpret_cast<std::uintptr_t>(out) % alignment == 0;
+                }
+
+                //! Interleaved loads of vec3 may read one float past the last element.
+                static const bool overreads = InSize == 3;
+
+                template <class FloatType>
+                void operator()(const matrix<vector, FloatType, 4, 4>& m, size_t i, bool streaming) const
+                {
+                    typedef detail::batch_traits<FloatType> traits;
+
+                    FloatType v[InSize];
+                    traits::load_interleaved(in + i * InSize, v);
+
+                    FloatType r[OutSize];
+                    transform<W>(m, v, r);
+
+                    float* dst = out + i * OutSize;
+                    if (streaming)
+                    {
+                        // interleave on the stack, then stream; size * OutSize floats keep dst aligned
+                        float block[traits::size * OutSize];
+                        traits::store_interleaved(r, block);
+                        for (size_t c = 0; c < OutSize; ++c)
+                        {
+                            traits::stream(traits::load(block + c * traits::size), dst + c * traits::size);
+                        }
+                    }
+                    else
+                    {
+                        traits::store_interleaved(r, dst);
+                    }
+                }
+
+                //! One element at a time; columns are broadcast instead, so that vec4 operations do the work.
+                void operator()(const mat4_type& m, size_t i, bool) const
+                {
+                    const float* src = in + i * InSize;
+                    vector<float, 4> r = m[0] * src[0];
+                    r += m[1] * src[1];
+                    r += m[2] * src[2];
+                    if (W == w_one)
+                    {
+                        r += m[3];
+                    }
+                    else if (W == w_read)
+                    {
+                        r += m[3] * src[3];
+                    }
+                    float* dst = out + i * OutSize;
+                    for (size_t c = 0; c < OutSize; ++c)
+                    {
+                        dst[c] = r[c];
+                    }
+                }
+            };
+
+            //! Separate x, y, z arrays; loads and stores are contiguous.
+            template <w_source W>
+            struct soa_step
+            {
+                soa3_span<const float> in;
+                soa3_span<float> out;
+
+                static const bool overreads = false;
+
+                bool is_output_aligned(size_t alignment) const
+                {
+                    return (reinterpret_cast<std::uintptr_t>(out.x) | reinterpret_cast<std::uintptr_t>(out.y) | reinterpret_cast<std::uintptr_t>(out.z)) % alignment == 0;
+                }
+
+                template <class FloatType>
+                void operator()(const matrix<vector, FloatType, 4, 4>& m, size_t i, bool streaming) const
+                {
+                    typedef detail::batch_traits<FloatType> traits;
+
+                    FloatType v[3] = { traits::load(in.x + i), traits::load(in.y + i), traits::load(in.z + i) };
+                    FloatType r[3];
+                    transform<W>(m, v, r);
+
+                    if (streaming)
+                    {
+                        traits::stream(r[0], out.x + i);
+                        traits::stream(r[1], out.y + i);
+                        traits::stream(r[2], out.z + i);
+                    }
+                    else
+                    {
+                        traits::store(r[0], out.x + i);
+                        traits::store(r[1], out.y + i);
+                        traits::store(r[2], out.z + i);
+                    }
+                }
+            };
+
+            //! Broadcasts the matrix once and runs the step for each whole batch of FloatType lanes, in parallel
+            //! for large counts; remaining elements go through the float path.
+            template <class FloatType, class Step>
+            void run(const mat4_type& m, size_t count, const Step& step)
+            {
+                typedef detail::batch_traits<FloatType> traits;
+
+                const auto wide = broadcast<FloatType>(m);
+                const bool large = count >= CXXSWIZZLE_BATCH_LARGE_THRESHOLD;
+                const bool streaming = large && step.is_output_aligned(traits::alignment);
+                std::ptrdiff_t batches = static_cast<std::ptrdiff_t>(count / traits::size);
+                if (Step::overreads && batches > 0 && count % traits::size == 0)
+                {
+                    // the last element must not be read past
+                    --batches;
+                }
+
+#ifdef _OPENMP
+#pragma omp parallel if(large)
+#endif
+                {
+#ifdef _OPENMP
+#pragma omp for
+#endif
+                    for (std::ptrdiff_t batch = 0; batch < batches; ++batch)
+                    {
+                        step(wide, static_cast<size_t>(batch) * traits::size, streaming);
+                    }
+
+                    // non-temporal stores are weakly ordered; each thread needs to fence its own
+                    if (streaming)
+                    {
+                        traits::stream_fence();
+                    }
+                }
+
+                for (size_t i = static_cast<size_t>(batches) * traits::size; i < count; ++i)
+                {
+                    step(m, i, false);
+                }
+            }
+
+            template <class FloatType, w_source W, size_t InSize, size_t OutSize>
+            void run_aos(const mat4_type& m, const vector<float, InSize>* in, vector<float, OutSize>* out, size_t count)
+            {
+                static_assert(sizeof(vector<float, InSize>) == InSize * sizeof(float) && sizeof(vector<float, OutSize>) == OutSize * sizeof(float), "Vectors need to be tightly packed");
+                static_assert(InSize >= 3 && InSize <= 4 && OutSize >= 3 && OutSize <= 4, "Only vec3 and vec4 spans are supported");
+
+                if (count)
+                {
+                    aos_step<W, InSize, OutSize> step = { &in[0][0], &out[0][0] };
+                    run<FloatType>(m, count, step);
+                }
+            }
+
+            inline mat4_type normal_matrix(const mat4_type& m)
+            {
+                return mat4_type(transpose(inverse(mat3_type(m))));
+            }
+        }
+
+        //! Transforms count points by m; vec3 inputs get w = 1, vec4 inputs keep theirs. Dropping to vec3
+        //! output does not divide by w. FloatType is the float type used for the computation, e.g. vc_float
+        //! to process whole SIMD vectors at a time (requires detail::batch_traits specialisation).
+        //! Large spans are processed in parallel and, if out is aligned, with non-temporal stores.
+        //! in and out must not overlap.
+        template <class FloatType = float, size_t InSize, size_t OutSize>
+        void transform_points(const batch_detail::mat4_type& m, const vector<float, InSize>* in, vector<float, OutSize>* out, size_t count)
+        {
+            batch_detail::run_aos<FloatType, InSize == 4 ? batch_detail::w_read : batch_detail::w_one>(m, in, out, count);
+        }
+
+        //! Transforms count directions by m, i.e. w = 0 and translation is ignored. See transform_points.
+        template <class FloatType = float, size_t InSize, size_t OutSize>
+        void transform_directions(const batch_detail::mat4_type& m, const vector<float, InSize>* in, vector<float, OutSize>* out, size_t count)
+        {
+            batch_detail::run_aos<FloatType, batch_detail::w_zero>(m, in, out, count);
+        }
+
+        //! Transforms count normals by the inverse transpose of m's upper 3x3, so that they stay perpendicular
+        //! to surfaces under non-uniform scaling. Results are not normalised. See transform_points.
+        template <class FloatType = float>
+        void transform_normals(const batch_detail::mat4_type& m, const vector<float, 3>* in, vector<float, 3>* out, size_t count)
+        {
+            batch_detail::run_aos<FloatType, batch_detail::w_zero>(batch_detail::normal_matrix(m), in, out, count);
+        }
+
+        //! SoA version of transform_points; streams only if all three outputs are aligned.
+        template <class FloatType = float>
+        void transform_points(const batch_detail::mat4_type& m, const soa3_span<const float>& in, const soa3_span<float>& out, size_t count)
+        {
+            batch_detail::soa_step<batch_detail::w_one> step = { in, out };
+            batch_detail::run<FloatType>(m, count, step);
+        }
+
+        //! SoA version of transform_directions.
+        template <class FloatType = float>
+        void transform_directions(const batch_detail::mat4_type& m, const soa3_span<const float>& in, const soa3_span<float>& out, size_t count)
+        {
+            batch_detail::soa_step<batch_detail::w_zero> step = { in, out };
+            batch_detail::run<FloatType>(m, count, step);
+        }
+
+        //! SoA version of transform_normals.
+        template <class FloatType = float>
+        void transform_normals(const batch_detail::mat4_type& m, const soa3_span<const float>& in, const soa3_span<float>& out, size_t count)
+        {
+            batch_detail::soa_step<batch_detail::w_zero> step = { in, out };
+            batch_detail::run<FloatType>(batch_detail::normal_matrix(m), count, step);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! A FIFO between the stages of a pipeline, any number of threads on either side. push() waits
+        //! while the queue is full, so that a fast stage can only get so far ahead of a slow one (and
+        //! hold so much memory); pop() waits while it is empty. Once closed, pushing fails and popping
+        //! drains what is left, then fails too, so that consumers know to finish.
+        template <class T>
+        class bounded_queue
+        {
+        public:
+            explicit bounded_queue(size_t capacity)
+                : m_capacity(capacity ? capacity : 1)
+                , m_closed(false)
+            {}
+
+            //! False, with the value dropped, if the queue is closed.
+            bool push(T value)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_not_full.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+                if (m_closed)
+                {
+                    return false;
+                }
+                m_items.push_back(std::move(value));
+                lock.unlock();
+                m_not_empty.notify_one();
+                return true;
+            }
+
+            //! False once the queue is closed and empty.
+            bool pop(T& value)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_not_empty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+                if (m_items.empty())
+                {
+                    return false;
+                }
+                value = std::move(m_items.front());
+                m_items.pop_front();
+                lock.unlock();
+                m_not_full.notify_one();
+                return true;
+            }
+
+            //! Wakes everyone waiting; can not be undone.
+            void close()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_closed = true;
+                }
+                m_not_full.notify_all();
+                m_not_empty.notify_all();
+            }
+
+            size_t capacity() const
+            {
+                return m_capacity;
+            }
+
+        private:
+            size_t m_capacity;
+            bool m_closed;
+            std::deque<T> m_items;
+            std::mutex m_mutex;
+            std::condition_variable m_not_full;
+            std::condition_variable m_not_empty;
+        };
+    }
+}
@@ -0,0 +1,1374 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include <swizzle/detail/deflate.h>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! Reading and writing PPM/PGM, PFM, TGA and PNG images, with no dependencies. Pixels go straight
+        //! between a stream and an image_view, i.e. any strided RGBA layout of bytes or floats, a row at a
+        //! time: a framebuffer is encoded in place and a sampler's texels decoded right where they end up.
+        namespace image_io
+        {
+            enum file_format
+            {
+                format_unknown,
+                //! binary P5 (grey) and P6 (RGB), 8 or 16 bit
+                format_ppm,
+                //! PF (RGB) and Pf (grey), 32 bit float; HDR
+                format_pfm,
+                //! uncompressed and RLE, 24/32 bit true colour and 8 bit grey
+                format_tga,
+                //! all colour types and depths, interlaced or not
+                format_png
+            };
+
+            //! By extension: .ppm/.pgm/.pnm, .pfm, .tga, .png; case insensitive.
+            inline file_format format_from_path(const char* path)
+            {
+                const char* dot = std::strrchr(path, '.');
+                if (!dot)
+                {
+                    return format_unknown;
+                }
+
+                char ext[5] = {};
+                for (size_t i = 0; i < 4 && dot[i + 1]; ++i)
+                {
+                    ext[i] = static_cast<char>(dot[i + 1] | 0x20);
+                }
+                if (!std::strcmp(ext, "ppm") || !std::strcmp(ext, "pgm") || !std::strcmp(ext, "pnm"))
+                {
+                    return format_ppm;
+                }
+                if (!std::strcmp(ext, "pfm"))
+                {
+                    return format_pfm;
+                }
+                if (!std::strcmp(ext, "tga"))
+                {
+                    return format_tga;
+                }
+                if (!std::strcmp(ext, "png"))
+                {
+                    return format_png;
+                }
+                return format_unknown;
+            }
+
+            //! Pixels somewhere in memory. Row 0 is the top one; rows are pitch elements apart (negative for
+            //! bottom-up storage), pixels stride elements apart, and R, G, B and A are at channels[0 - 3]
+            //! within a pixel, -1 for ones that are not there. T is (const) std::uint8_t, for unorm values,
+            //! or (const) float.
+            template <class T>
+            struct image_view
+            {
+                T* data;
+                size_t width;
+                size_t height;
+                std::ptrdiff_t pitch;
+                size_t stride;
+                int channels[4];
+
+                T* pixel(size_t x, size_t y) const
+                {
+                    return data + static_cast<std::ptrdiff_t>(y) * pitch + static_cast<std::ptrdiff_t>(x * stride);
+                }
+            };
+
+            //! Tightly packed RGBA, top-down or, like textures, bottom-up.
+            template <class T>
+            image_view<T> rgba_view(T* data, size_t width, size_t height, bool bottom_up = false)
+            {
+                const std::ptrdiff_t pitch = static_cast<std::ptrdiff_t>(width * 4);
+                image_view<T> result = { bottom_up && height ? data + (height - 1) * width * 4 : data, width, height, bottom_up ? -pitch : pitch, 4, { 0, 1, 2, 3 } };
+                return result;
+            }
+        }
+    }
+
+    namespace detail
+    {
+        namespace image_io
+        {
+            //! Both dimensions up to 64k and at most 256M pixels, which keeps texel offsets within 32 bits.
+            inline bool valid_size(std::uint64_t width, std::uint64_t height)
+            {
+                return width && height && width <= 65536 && height <= 65536 && width * height <= (static_cast<std::uint64_t>(1) << 28);
+            }
+
+            inline void store(std::uint8_t& dst, unsigned value, unsigned max)
+            {
+                dst = static_cast<std::uint8_t>(max == 255 ? value : (value * 255 + max / 2) / max);
+            }
+
+            inline void store(float& dst, unsigned value, unsigned max)
+            {
+                dst = static_cast<float>(value) / static_cast<float>(max);
+            }
+
+            inline void store(std::uint8_t& dst, float value)
+            {
+                dst = static_cast<std::uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+            }
+
+            inline void store(float& dst, float value)
+            {
+                dst = value;
+            }
+
+            inline unsigned load_byte(std::uint8_t value)
+            {
+                return value;
+            }
+
+            inline unsigned load_byte(float value)
+            {
+                // written this way NaNs end up as 0
+                return value > 0.0f ? static_cast<unsigned>(std::min(value, 1.0f) * 255.0f + 0.5f) : 0;
+            }
+
+            inline float load_float(std::uint8_t value)
+            {
+                return value * (1.0f / 255.0f);
+            }
+
+            inline float load_float(float value)
+            {
+                return value;
+            }
+
+            //! Integer samples with a maximum value, e.g. 255 or 65535.
+            template <class T>
+            void store_pixel(const swizzle::glsl::image_io::image_view<T>& view, T* pixel, unsigned r, unsigned g, unsigned b, unsigned a, unsigned max)
+            {
+                const unsigned values[] = { r, g, b, a };
+                for (int c = 0; c < 4; ++c)
+                {
+                    if (view.channels[c] >= 0)
+                    {
+                        store(pixel[view.channels[c]], values[c], max);
+                    }
+                }
+            }
+
+            template <class T>
+            void store_pixel(const swizzle::glsl::image_io::image_view<T>& view, T* pixel, float r, float g, float b, float a)
+            {
+                const float values[] = { r, g, b, a };
+                for (int c = 0; c < 4; ++c)
+                {
+                    if (view.channels[c] >= 0)
+                    {
+                        store(pixel[view.channels[c]], values[c]);
+                    }
+                }
+            }
+
+            //! Missing colour channels read as 0, missing alpha as opaque.
+            template <class T>
+            unsigned load_channel_byte(const swizzle::glsl::image_io::image_view<const T>& view, const T* pixel, int c)
+            {
+                return view.channels[c] >= 0 ? load_byte(pixel[view.channels[c]]) : (c == 3 ? 255 : 0);
+            }
+
+            template <class T>
+            float load_channel_float(const swizzle::glsl::image_io::image_view<const T>& view, const T* pixel, int c)
+            {
+                return view.channels[c] >= 0 ? load_float(pixel[view.channels[c]]) : (c == 3 ? 1.0f : 0.0f);
+            }
+
+            //! std::istream with a buffer, so that formats can be parsed byte by byte cheaply. Reads past
+            //! the end return 0 and set failed().
+            class byte_reader
+            {
+            public:
+                explicit byte_reader(std::istream& in)
+                    : m_in(in)
+                    , m_pos(0)
+                    , m_end(0)
+                    , m_failed(false)
+                {}
+
+                std::uint8_t get()
+                {
+                    if (m_pos == m_end && !fill())
+                    {
+                        m_failed = true;
+                        return 0;
+                    }
+                    return m_buffer[m_pos++];
+                }
+
+                //! Reads up to size bytes, fewer only at the end.
+                size_t read(std::uint8_t* data, size_t size)
+                {
+                    size_t done = 0;
+                    while (done < size && (m_pos < m_end || fill()))
+                    {
+                        const size_t n = std::min(size - done, m_end - m_pos);
+                        std::memcpy(data + done, m_buffer + m_pos, n);
+                        m_pos += n;
+                        done += n;
+                    }
+                    return done;
+                }
+
+                bool read_all(std::uint8_t* data, size_t size)
+                {
+                    if (read(data, size) != size)
+                    {
+                        m_failed = true;
+                    }
+                    return !m_failed;
+                }
+
+                void skip(size_t size)
+                {
+                    for (; size && !m_failed; --size)
+                    {
+                        get();
+                    }
+                }
+
+                std::uint32_t get_be32()
+                {
+                    std::uint32_t result = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        result = (result << 8) | get();
+                    }
+                    return result;
+                }
+
+                bool failed() const
+                {
+                    return m_failed;
+                }
+
+            private:
+                bool fill()
+                {
+                    m_in.read(reinterpret_cast<char*>(m_buffer), sizeof(m_buffer));
+                    m_pos = 0;
+                    m_end = static_cast<size_t>(m_in.gcount());
+                    return m_end != 0;
+                }
+
+                std::istream& m_in;
+                std::uint8_t m_buffer[16384];
+                size_t m_pos;
+                size_t m_end;
+                bool m_failed;
+            };
+
+            inline bool is_little_endian()
+            {
+                const std::uint32_t one = 1;
+                std::uint8_t first;
+                std::memcpy(&first, &one, 1);
+                return first == 1;
+            }
+
+            inline void put_be32(std::uint8_t* dst, std::uint32_t value)
+            {
+                dst[0] = static_cast<std::uint8_t>(value >> 24);
+                dst[1] = static_cast<std::uint8_t>(value >> 16);
+                dst[2] = static_cast<std::uint8_t>(value >> 8);
+                dst[3] = static_cast<std::uint8_t>(value);
+            }
+
+            inline void write_png_chunk(std::ostream& out, const char* type, const std::uint8_t* data, size_t size)
+            {
+                std::uint8_t header[8];
+                put_be32(header, static_cast<std::uint32_t>(size));
+                std::memcpy(header + 4, type, 4);
+                std::uint32_t crc = deflate::crc32(0, header + 4, 4);
+                crc = deflate::crc32(crc, data, size);
+                std::uint8_t trailer[4];
+                put_be32(trailer, crc);
+
+                out.write(reinterpret_cast<const char*>(header), 8);
+                out.write(reinterpret_cast<const char*>(data), size);
+                out.write(reinterpret_cast<const char*>(trailer), 4);
+            }
+
+            //! Deflater output, cut into IDAT chunks.
+            struct png_idat_writer
+            {
+                std::ostream& out;
+                std::vector<std::uint8_t> data;
+
+                void operator()(const std::uint8_t* bytes, size_t size)
+                {
+                    data.insert(data.end(), bytes, bytes + size);
+                    if (data.size() >= 65536)
+                    {
+                        flush();
+                    }
+                }
+
+                void flush()
+                {
+                    if (!data.empty())
+                    {
+                        write_png_chunk(out, "IDAT", data.data(), data.size());
+                        data.clear();
+                    }
+                }
+            };
+
+            inline unsigned paeth(unsigned a, unsigned b, unsigned c)
+            {
+                const int p = static_cast<int>(a + b) - static_cast<int>(c);
+                const int pa = std::abs(p - static_cast<int>(a));
+                const int pb = std::abs(p - static_cast<int>(b));
+                const int pc = std::abs(p - static_cast<int>(c));
+                return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+            }
+        }
+    }
+
+    namespace glsl
+    {
+        namespace image_io
+        {
+            //! Reads the header on construction, so that the size is known before pixels are read, with
+            //! read(), into a view of that size. The format is recognised by its signature. Single use.
+            class reader
+            {
+            public:
+                explicit reader(std::istream& in)
+                    : m_in(in)
+                    , m_format(format_unknown)
+                    , m_width(0)
+                    , m_height(0)
+                    , m_channels(0)
+                    , m_error(nullptr)
+                    , m_max(255)
+                    , m_little_endian(false)
+                    , m_type(0)
+                    , m_depth(0)
+                    , m_top_down(false)
+                    , m_right_to_left(false)
+                    , m_interlaced(false)
+                    , m_samples(0)
+                    , m_palette_size(0)
+                    , m_has_key(false)
+                    , m_chunk_left(0)
+                    , m_chunk_crc(0)
+                    , m_idat_done(false)
+                {
+                    read_header();
+                }
+
+                //! False if the header could not be read or, after read(), if the pixels could not.
+                bool valid() const
+                {
+                    return !m_error;
+                }
+
+                //! What went wrong, if anything did.
+                const char* error() const
+                {
+                    return m_error ? m_error : "";
+                }
+
+                file_format format() const
+                {
+                    return m_format;
+                }
+
+                size_t width() const
+                {
+                    return m_width;
+                }
+
+                size_t height() const
+                {
+                    return m_height;
+                }
+
+                //! In the file: 1 grey, 2 grey and alpha, 3 RGB, 4 RGBA.
+                unsigned channels() const
+                {
+                    return m_channels;
+                }
+
+                //! Floating point values, possibly outside of [0, 1].
+                bool hdr() const
+                {
+                    return m_format == format_pfm;
+                }
+
+                //! view needs to be width() x height(). Grey is replicated to R, G and B, missing alpha is 1,
+                //! channels missing in the view are skipped; floats are clamped when stored as bytes.
+                template <class T>
+                bool read(const image_view<T>& view)
+                {
+                    if (m_error)
+                    {
+                        return false;
+                    }
+                    if (view.width != m_width || view.height != m_height)
+                    {
+                        return fail("view size does not match the image");
+                    }
+
+                    switch (m_format)
+                    {
+                    case format_ppm:
+                        read_ppm(view);
+                        break;
+                    case format_pfm:
+                        read_pfm(view);
+                        break;
+                    case format_tga:
+                        read_tga(view);
+                        break;
+                    case format_png:
+                        read_png(view);
+                        break;
+                    default:
+                        break;
+                    }
+                    if (!m_error && m_in.failed())
+                    {
+                        fail("unexpected end of file");
+                    }
+                    return !m_error;
+                }
+
+                //! The whole image as RGBA floats, e.g. for a texture, whose rows go bottom-up.
+                bool read_rgba(std::vector<float>& rgba, bool bottom_up)
+                {
+                    rgba.assign(m_width * m_height * 4, 0.0f);
+                    return read(rgba_view(rgba.data(), m_width, m_height, bottom_up));
+                }
+
+            private:
+                bool fail(const char* error)
+                {
+                    if (!m_error)
+                    {
+                        m_error = error;
+                    }
+                    return false;
+                }
+
+                void read_header()
+                {
+                    const std::uint8_t first = m_in.get();
+                    const std::uint8_t second = m_in.get();
+                    if (m_in.failed())
+                    {
+                        fail("empty file");
+                    }
+                    else if (first == 'P' && (second == '5' || second == '6'))
+                    {
+                        m_format = format_ppm;
+                        m_channels = second == '5' ? 1 : 3;
+                        read_ppm_header();
+                    }
+                    else if (first == 'P' && (second == 'F' || second == 'f'))
+                    {
+                        m_format = format_pfm;
+                        m_channels = second == 'f' ? 1 : 3;
+                        read_pfm_header();
+                    }
+                    else if (first == 0x89 && second == 'P')
+                    {
+                        m_format = format_png;
+                        read_png_header();
+                    }
+                    else if (second <= 1)
+                    {
+                        // TGA has no signature; the second byte is the colour map type, 0 or 1
+                        m_format = format_tga;
+                        read_tga_header(first, second);
+                    }
+                    else
+                    {
+                        fail("unknown format");
+                    }
+
+                    if (!m_error && !detail::image_io::valid_size(m_width, m_height))
+                    {
+                        fail("invalid or too large image size");
+                    }
+                    if (m_in.failed())
+                    {
+                        fail("unexpected end of file");
+                    }
+                }
+
+                // PPM / PFM
+
+                //! Skips whitespace and comments; the single whitespace after the last number is left.
+                unsigned read_number()
+                {
+                    std::uint8_t c = m_in.get();
+                    while (!m_in.failed() && (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#'))
+                    {
+                        if (c == '#')
+                        {
+                            while (!m_in.failed() && c != '\n')
+                            {
+                                c = m_in.get();
+                            }
+                        }
+                        c = m_in.get();
+                    }
+
+                    std::uint64_t result = 0;
+                    if (c < '0' || c > '9')
+                    {
+                        fail("invalid header");
+                        return 0;
+                    }
+                    for (; c >= '0' && c <= '9' && !m_in.failed(); c = m_in.get())
+                    {
+                        result = std::min<std::uint64_t>(result * 10 + (c - '0'), 0xffffffffu);
+                    }
+                    // that was the whitespace
+                    return static_cast<unsigned>(result);
+                }
+
+                void read_ppm_header()
+                {
+                    m_width = read_number();
+                    m_height = read_number();
+                    m_max = read_number();
+                    if (m_max == 0 || m_max > 65535)
+                    {
+                        fail("invalid maximum value");
+                    }
+                }
+
+                template <class T>
+                void read_ppm(const image_view<T>& view)
+                {
+                    const size_t bytes = m_max > 255 ? 2 : 1;
+                    std::vector<std::uint8_t> row(m_width * m_channels * bytes);
+                    for (size_t y = 0; y < m_height && m_in.read_all(row.data(), row.size()); ++y)
+                    {
+                        const std::uint8_t* src = row.data();
+                        for (size_t x = 0; x < m_width; ++x)
+                        {
+                            unsigned values[3];
+                            for (unsigned c = 0; c < m_channels; ++c, src += bytes)
+                            {
+                                values[c] = bytes == 2 ? (src[0] << 8) | src[1] : src[0];
+                                values[c] = std::min(values[c], m_max);
+                            }
+                            const unsigned g = m_channels == 3 ? values[1] : values[0];
+                            const unsigned b = m_channels == 3 ? values[2] : values[0];
+                            detail::image_io::store_pixel(view, view.pixel(x, y), values[0], g, b, m_max, m_max);
+                        }
+                    }
+                }
+
+                void read_pfm_header()
+                {
+                    m_width = read_number();
+                    m_height = read_number();
+
+                    // only the sign of the scale matters: negative is little endian
+                    std::uint8_t c = m_in.get();
+                    while (!m_in.failed() && (c == ' ' || c == '\t' || c == '\r' || c == '\n'))
+                    {
+                        c = m_in.get();
+                    }
+                    m_little_endian = c == '-';
+                    while (!m_in.failed() && c != '\n' && c != '\r' && c != ' ' && c != '\t')
+                    {
+                        c = m_in.get();
+                    }
+                }
+
+                template <class T>
+                void read_pfm(const image_view<T>& view)
+                {
+                    const bool swap = m_little_endian != detail::image_io::is_little_endian();
+                    std::vector<std::uint8_t> row(m_width * m_channels * sizeof(float));
+                    // rows go bottom-up
+                    for (size_t y = m_height; y-- > 0 && m_in.read_all(row.data(), row.size());)
+                    {
+                        for (size_t x = 0; x < m_width; ++x)
+                        {
+                            float values[3] = {};
+                            for (unsigned c = 0; c < m_channels; ++c)
+                            {
+                                std::uint8_t* src = &row[(x * m_channels + c) * sizeof(float)];
+                                if (swap)
+                                {
+                                    std::swap(src[0], src[3]);
+                                    std::swap(src[1], src[2]);
+                                }
+                                std::memcpy(&values[c], src, sizeof(float));
+                            }
+                            const float g = m_channels == 3 ? values[1] : values[0];
+                            const float b = m_channels == 3 ? values[2] : values[0];
+                            detail::image_io::store_pixel(view, view.pixel(x, y), values[0], g, b, 1.0f);
+                        }
+                    }
+                }
+
+                // TGA
+
+                void read_tga_header(std::uint8_t id_length, std::uint8_t colour_map_type)
+                {
+                    std::uint8_t header[16];
+                    m_in.read_all(header, sizeof(header));
+                    m_type = header[0];
+                    const size_t map_length = header[3] | (header[4] << 8);
+                    const size_t map_bits = header[5];
+                    m_width = header[10] | (header[11] << 8);
+                    m_height = header[12] | (header[13] << 8);
+                    m_depth = header[14];
+                    m_top_down = (header[15] & 0x20) != 0;
+                    m_right_to_left = (header[15] & 0x10) != 0;
+
+                    const bool grey = m_type == 3 || m_type == 11;
+                    if (m_type != 2 && m_type != 3 && m_type != 10 && m_type != 11)
+                    {
+                        fail("unsupported TGA type, colour mapped or not an image");
+                    }
+                    else if (grey ? m_depth != 8 : (m_depth != 24 && m_depth != 32))
+                    {
+                        fail("unsupported TGA depth");
+                    }
+                    m_channels = grey ? 1 : m_depth / 8;
+
+                    // a colour map of a true colour image is of no use
+                    m_in.skip(id_length + (colour_map_type ? map_length * ((map_bits + 7) / 8) : 0));
+                }
+
+                template <class T>
+                void read_tga(const image_view<T>& view)
+                {
+                    const bool rle = m_type >= 9;
+                    const size_t bytes = m_depth / 8;
+                    std::uint8_t pixel[4] = {};
+                    size_t run = 0;
+                    bool repeat = false;
+
+                    // runs may cross rows
+                    for (size_t row = 0; row < m_height && !m_in.failed(); ++row)
+                    {
+                        const size_t y = m_top_down ? row : m_height - 1 - row;
+                        for (size_t column = 0; column < m_width; ++column)
+                        {
+                            if (!rle)
+                            {
+                                m_in.read_all(pixel, bytes);
+                            }
+                            else
+                            {
+                                if (!run)
+                                {
+                                    const std::uint8_t packet = m_in.get();
+                                    run = (packet & 0x7f) + 1;
+                                    repeat = (packet & 0x80) != 0;
+                                    if (repeat)
+                                    {
+                                        m_in.read_all(pixel, bytes);
+                                    }
+                                }
+                                if (!repeat)
+                                {
+                                    m_in.read_all(pixel, bytes);
+                                }
+                                --run;
+                            }
+
+                            const size_t x = m_right_to_left ? m_width - 1 - column : column;
+                            if (bytes == 1)
+                            {
+                                detail::image_io::store_pixel(view, view.pixel(x, y), pixel[0], pixel[0], pixel[0], 255, 255);
+                            }
+                            else
+                            {
+                                // BGR(A)
+                                detail::image_io::store_pixel(view, view.pixel(x, y), pixel[2], pixel[1], pixel[0], bytes == 4 ? pixel[3] : 255, 255);
+                            }
+                        }
+                    }
+                }
+
+                // PNG
+
+                void read_png_header()
+                {
+                    static const std::uint8_t signature[] = { 'N', 'G', '\r', '\n', 0x1a, '\n' };
+                    std::uint8_t rest[6];
+                    if (!m_in.read_all(rest, 6) || std::memcmp(rest, signature, 6))
+                    {
+                        fail("invalid PNG signature");
+                        return;
+                    }
+
+                    // everything up to the first IDAT; the chunk is left open
+                    bool first = true;
+                    while (!m_error && !m_in.failed())
+                    {
+                        const std::uint32_t length = m_in.get_be32();
+                        std::uint8_t type[4];
+                        m_in.read_all(type, 4);
+                        if (length > 0x7fffffffu)
+                        {
+                            fail("invalid PNG chunk");
+                            return;
+                        }
+                        if (first != !std::memcmp(type, "IHDR", 4))
+                        {
+                            fail("IHDR is not the first PNG chunk");
+                            return;
+                        }
+                        first = false;
+
+                        m_chunk_crc = detail::deflate::crc32(0, type, 4);
+                        if (!std::memcmp(type, "IDAT", 4))
+                        {
+                            m_chunk_left = length;
+                            return;
+                        }
+                        if (!std::memcmp(type, "IEND", 4))
+                        {
+                            fail("no PNG image data");
+                            return;
+                        }
+
+                        // the ones needed are short, others are skipped
+                        const bool wanted = !std::memcmp(type, "IHDR", 4) || !std::memcmp(type, "PLTE", 4) || !std::memcmp(type, "tRNS", 4);
+                        if (!wanted && !(type[0] & 0x20))
+                        {
+                            fail("unknown critical PNG chunk");
+                            return;
+                        }
+                        std::vector<std::uint8_t> data;
+                        if (wanted)
+                        {
+                            data.resize(length);
+                            m_in.read_all(data.data(), length);
+                            m_chunk_crc = detail::deflate::crc32(m_chunk_crc, data.data(), length);
+                            if (m_in.get_be32() != m_chunk_crc)
+                            {
+                                fail("PNG chunk CRC mismatch");
+                                return;
+                            }
+                        }
+                        else
+                        {
+                            m_in.skip(length + 4);
+                        }
+
+                        if (!std::memcmp(type, "IHDR", 4))
+                        {
+                            read_png_ihdr(data);
+                        }
+                        else if (!std::memcmp(type, "PLTE", 4))
+                        {
+                            if (length % 3 || length > 256 * 3)
+                            {
+                                fail("invalid PNG palette");
+                                return;
+                            }
+                            m_palette_size = length / 3;
+                            for (size_t i = 0; i < m_palette_size; ++i)
+                            {
+                                m_palette[i * 4] = data[i * 3];
+                                m_palette[i * 4 + 1] = data[i * 3 + 1];
+                                m_palette[i * 4 + 2] = data[i * 3 + 2];
+                                m_palette[i * 4 + 3] = 255;
+                            }
+                        }
+                        else if (!std::memcmp(type, "tRNS", 4))
+                        {
+                            if (m_type == 3)
+                            {
+                                for (size_t i = 0; i < length && i < m_palette_size; ++i)
+                                {
+                                    m_palette[i * 4 + 3] = data[i];
+                                }
+                            }
+                            else if ((m_type == 0 && length >= 2) || (m_type == 2 && length >= 6))
+                            {
+                                m_has_key = true;
+                                for (size_t i = 0; i < (m_type == 0 ? 1u : 3u); ++i)
+                                {
+                                    m_key[i] = (data[i * 2] << 8) | data[i * 2 + 1];
+                                }
+                            }
+                        }
+                    }
+                }
+
+                void read_png_ihdr(const std::vector<std::uint8_t>& data)
+                {
+                    if (data.size() != 13)
+                    {
+                        fail("invalid PNG header");
+                        return;
+                    }
+                    m_width = (static_cast<std::uint32_t>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+                    m_height = (static_cast<std::uint32_t>(data[4]) << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+                    m_depth = data[8];
+                    m_type = data[9];
+                    m_interlaced = data[12] == 1;
+
+                    static const unsigned samples[] = { 1, 0, 3, 1, 2, 0, 4 };
+                    const unsigned d = m_depth;
+                    bool valid = false;
+                    switch (m_type)
+                    {
+                    case 0:
+                        valid = d == 1 || d == 2 || d == 4 || d == 8 || d == 16;
+                        break;
+                    case 3:
+                        valid = d == 1 || d == 2 || d == 4 || d == 8;
+                        break;
+                    case 2:
+                    case 4:
+                    case 6:
+                        valid = d == 8 || d == 16;
+                        break;
+                    }
+                    if (!valid || data[10] != 0 || data[11] != 0 || data[12] > 1)
+                    {
+                        fail("unsupported PNG colour type, depth or method");
+                        return;
+                    }
+                    m_samples = samples[m_type];
+                    m_channels = m_type == 3 ? 4 : m_samples;
+                }
+
+                //! The inflater's source: data of consecutive IDAT chunks, CRCs checked.
+                struct idat_source
+                {
+                    reader& owner;
+
+                    size_t operator()(std::uint8_t* buffer, size_t size)
+                    {
+                        detail::image_io::byte_reader& in = owner.m_in;
+                        while (!owner.m_chunk_left && !owner.m_idat_done)
+                        {
+                            if (in.get_be32() != owner.m_chunk_crc)
+                            {
+                                owner.fail("PNG chunk CRC mismatch");
+                            }
+                            const std::uint32_t length = in.get_be32();
+                            std::uint8_t type[4];
+                            in.read_all(type, 4);
+                            owner.m_chunk_crc = detail::deflate::crc32(0, type, 4);
+                            owner.m_chunk_left = length;
+                            owner.m_idat_done = owner.m_error || in.failed() || std::memcmp(type, "IDAT", 4) != 0;
+                        }
+                        if (owner.m_idat_done)
+                        {
+                            return 0;
+                        }
+
+                        const size_t n = in.read(buffer, std::min<size_t>(size, owner.m_chunk_left));
+                        owner.m_chunk_crc = detail::deflate::crc32(owner.m_chunk_crc, buffer, n);
+                        owner.m_chunk_left -= n;
+                        if (!n)
+                        {
+                            owner.m_idat_done = true;
+                        }
+                        return n;
+                    }
+                };
+
+                //! Consumes inflated scanlines: unfilters and stores them, pass by pass if interlaced.
+                template <class T>
+                struct png_rows
+                {
+                    reader& owner;
+                    const image_view<T>& view;
+                    //! 0 - 6 are Adam7 passes, 7 the whole image.
+                    unsigned pass;
+                    unsigned last_pass;
+                    size_t x0, y0, dx, dy;
+                    size_t pass_width;
+                    size_t pass_height;
+                    size_t row;
+                    size_t filled;
+                    size_t pixel_bytes;
+                    std::vector<std::uint8_t> current;
+                    std::vector<std::uint8_t> previous;
+
+                    png_rows(reader& owner, const image_view<T>& view)
+                        : owner(owner)
+                        , view(view)
+                        , pass(owner.m_interlaced ? 0 : 7)
+                        , last_pass(owner.m_interlaced ? 6 : 7)
+                        , pixel_bytes(std::max(1u, owner.m_samples * owner.m_depth / 8))
+                    {
+                        start_pass();
+                    }
+
+                    bool done() const
+                    {
+                        return pass > last_pass;
+                    }
+
+                    //! Passes of images smaller than 5x5 may be empty, and are then not in the data at all.
+                    void start_pass()
+                    {
+                        static const unsigned pass_x0[] = { 0, 4, 0, 2, 0, 1, 0, 0 };
+                        static const unsigned pass_y0[] = { 0, 0, 4, 0, 2, 0, 1, 0 };
+                        static const unsigned pass_dx[] = { 8, 8, 4, 4, 2, 2, 1, 1 };
+                        static const unsigned pass_dy[] = { 8, 8, 8, 4, 4, 2, 2, 1 };
+                        for (; pass <= last_pass; ++pass)
+                        {
+                            x0 = pass_x0[pass];
+                            y0 = pass_y0[pass];
+                            dx = pass_dx[pass];
+                            dy = pass_dy[pass];
+                            if (owner.m_width > x0 && owner.m_height > y0)
+                            {
+                                pass_width = (owner.m_width - x0 + dx - 1) / dx;
+                                pass_height = (owner.m_height - y0 + dy - 1) / dy;
+                                row = 0;
+                                filled = 0;
+                                const size_t bytes = 1 + (pass_width * owner.m_samples * owner.m_depth + 7) / 8;
+                                current.assign(bytes, 0);
+                                previous.assign(bytes, 0);
+                                return;
+                            }
+                        }
+                    }
+
+                    void operator()(const std::uint8_t* data, size_t size)
+                    {
+                        while (size && !done())
+                        {
+                            const size_t n = std::min(size, current.size() - filled);
+                            std::memcpy(&current[filled], data, n);
+                            filled += n;
+                            data += n;
+                            size -= n;
+                            if (filled == current.size())
+                            {
+                                finish_row();
+                            }
+                        }
+                    }
+
+                    void finish_row()
+                    {
+                        std::uint8_t* cur = &current[1];
+                        const std::uint8_t* prev = &previous[1];
+                        const size_t bytes = current.size() - 1;
+                        const size_t bpp = pixel_bytes;
+                        switch (current[0])
+                        {
+                        case 0:
+                            break;
+                        case 1:
+                            for (size_t i = bpp; i < bytes; ++i)
+                            {
+                                cur[i] = static_cast<std::uint8_t>(cur[i] + cur[i - bpp]);
+                            }
+                            break;
+                        case 2:
+                            for (size_t i = 0; i < bytes; ++i)
+                            {
+                                cur[i] = static_cast<std::uint8_t>(cur[i] + prev[i]);
+                            }
+                            break;
+                        case 3:
+                            for (size_t i = 0; i < bytes; ++i)
+                            {
+                                const unsigned left = i >= bpp ? cur[i - bpp] : 0;
+                                cur[i] = static_cast<std::uint8_t>(cur[i] + ((left + prev[i]) >> 1));
+                            }
+                            break;
+                        case 4:
+                            for (size_t i = 0; i < bytes; ++i)
+                            {
+                                const unsigned left = i >= bpp ? cur[i - bpp] : 0;
+                                const unsigned corner = i >= bpp ? prev[i - bpp] : 0;
+                                cur[i] = static_cast<std::uint8_t>(cur[i] + detail::image_io::paeth(left, prev[i], corner));
+                            }
+                            break;
+                        default:
+                            owner.fail("invalid PNG filter");
+                            pass = last_pass + 1;
+                            return;
+                        }
+
+                        store_row(cur);
+                        current.swap(previous);
+                        filled = 0;
+                        if (++row == pass_height)
+                        {
+                            ++pass;
+                            start_pass();
+                        }
+                    }
+
+                    unsigned sample(const std::uint8_t* data, size_t index) const
+                    {
+                        switch (owner.m_depth)
+                        {
+                        case 16:
+                            return (data[index * 2] << 8) | data[index * 2 + 1];
+                        case 8:
+                            return data[index];
+                        default:
+                            {
+                                const size_t bit = index * owner.m_depth;
+                                const unsigned shift = 8 - owner.m_depth - static_cast<unsigned>(bit & 7);
+                                return (data[bit >> 3] >> shift) & ((1u << owner.m_depth) - 1);
+                            }
+                        }
+                    }
+
+                    void store_row(const std::uint8_t* data) const
+                    {
+                        const unsigned max = (1u << owner.m_depth) - 1;
+                        const size_t y = y0 + row * dy;
+                        for (size_t i = 0; i < pass_width; ++i)
+                        {
+                            T* pixel = view.pixel(x0 + i * dx, y);
+                            const size_t s = i * owner.m_samples;
+                            switch (owner.m_type)
+                            {
+                            case 0:
+                                {
+                                    const unsigned v = sample(data, s);
+                                    const unsigned a = owner.m_has_key && v == owner.m_key[0] ? 0 : max;
+                                    detail::image_io::store_pixel(view, pixel, v, v, v, a, max);
+                                }
+                                break;
+                            case 2:
+                                {
+                                    const unsigned r = sample(data, s), g = sample(data, s + 1), b = sample(data, s + 2);
+                                    const bool key = owner.m_has_key && r == owner.m_key[0] && g == owner.m_key[1] && b == owner.m_key[2];
+                                    detail::image_io::store_pixel(view, pixel, r, g, b, key ? 0 : max, max);
+                                }
+                                break;
+                            case 3:
+                                {
+                                    // indices past the palette are black
+                                    const unsigned index = sample(data, s);
+                                    const std::uint8_t* entry = index < owner.m_palette_size ? &owner.m_palette[index * 4] : nullptr;
+                                    if (entry)
+                                    {
+                                        detail::image_io::store_pixel(view, pixel, entry[0], entry[1], entry[2], entry[3], 255);
+                                    }
+                                    else
+                                    {
+                                        detail::image_io::store_pixel(view, pixel, 0, 0, 0, 255, 255);
+                                    }
+                                }
+                                break;
+                            case 4:
+                                {
+                                    const unsigned v = sample(data, s);
+                                    detail::image_io::store_pixel(view, pixel, v, v, v, sample(data, s + 1), max);
+                                }
+                                break;
+                            case 6:
+                            default:
+                                detail::image_io::store_pixel(view, pixel, sample(data, s), sample(data, s + 1), sample(data, s + 2), sample(data, s + 3), max);
+                                break;
+                            }
+                        }
+                    }
+                };
+
+                template <class T>
+                void read_png(const image_view<T>& view)
+                {
+                    if (m_type == 3 && !m_palette_size)
+                    {
+                        fail("PNG palette missing");
+                        return;
+                    }
+
+                    idat_source source = { *this };
+                    png_rows<T> rows(*this, view);
+                    // its input buffer is a bit much for the stack
+                    std::unique_ptr<detail::deflate::inflater<idat_source> > inflater(new detail::deflate::inflater<idat_source>(source));
+                    if (!inflater->inflate_zlib(rows))
+                    {
+                        fail("invalid PNG image data");
+                    }
+                    else if (!rows.done())
+                    {
+                        fail("PNG image data too short");
+                    }
+                }
+
+            private:
+                detail::image_io::byte_reader m_in;
+                file_format m_format;
+                size_t m_width;
+                size_t m_height;
+                unsigned m_channels;
+                const char* m_error;
+
+                //! PPM
+                unsigned m_max;
+                //! PFM
+                bool m_little_endian;
+                //! TGA image type or PNG colour type, and bits per pixel or per sample
+                unsigned m_type;
+                unsigned m_depth;
+                //! TGA
+                bool m_top_down;
+                bool m_right_to_left;
+                //! PNG
+                bool m_interlaced;
+                unsigned m_samples;
+                std::uint8_t m_palette[256 * 4];
+                size_t m_palette_size;
+                bool m_has_key;
+                unsigned m_key[3];
+                std::uint32_t m_chunk_left;
+                std::uint32_t m_chunk_crc;
+                bool m_idat_done;
+            };
+
+            //! Encodes a view, a row at a time: 8 bit RGB PPM, PFM (RGB, little or big endian as the host),
+            //! 24 or 32 bit TGA and 8 bit RGB(A) PNG, with alpha if the view has it. Views of bytes written
+            //! to PFM are scaled to [0, 1], floats written to the others are clamped to it. Returns false if
+            //! the format is unknown, the size too large for it or the stream failed.
+            template <class T>
+            bool write(std::ostream& out, file_format format, const image_view<const T>& view)
+            {
+                using namespace detail::image_io;
+
+                const size_t width = view.width;
+                const size_t height = view.height;
+                const bool alpha = view.channels[3] >= 0;
+                if (!width || !height)
+                {
+                    return false;
+                }
+
+                switch (format)
+                {
+                case format_ppm:
+                    {
+                        out << "P6\n" << width << " " << height << "\n255\n";
+                        std::vector<std::uint8_t> row(width * 3);
+                        for (size_t y = 0; y < height; ++y)
+                        {
+                            for (size_t x = 0; x < width; ++x)
+                            {
+                                const T* pixel = view.pixel(x, y);
+                                for (int c = 0; c < 3; ++c)
+                                {
+                                    row[x * 3 + c] = static_cast<std::uint8_t>(load_channel_byte(view, pixel, c));
+                                }
+                            }
+                            out.write(reinterpret_cast<const char*>(row.data()), row.size());
+                        }
+                    }
+                    break;
+                case format_pfm:
+                    {
+                        out << "PF\n" << width << " " << height << "\n" << (is_little_endian() ? "-1.0" : "1.0") << "\n";
+                        std::vector<float> row(width * 3);
+                        for (size_t y = height; y-- > 0;)
+                        {
+                            for (size_t x = 0; x < width; ++x)
+                            {
+                                const T* pixel = view.pixel(x, y);
+                                for (int c = 0; c < 3; ++c)
+                                {
+                                    row[x * 3 + c] = load_channel_float(view, pixel, c);
+                                }
+                            }
+                            out.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+                        }
+                    }
+                    break;
+                case format_tga:
+                    {
+                        if (width > 65535 || height > 65535)
+                        {
+                            return false;
+                        }
+                        const size_t bytes = alpha ? 4 : 3;
+                        std::uint8_t header[18] = {};
+                        header[2] = 2;
+                        header[12] = static_cast<std::uint8_t>(width);
+                        header[13] = static_cast<std::uint8_t>(width >> 8);
+                        header[14] = static_cast<std::uint8_t>(height);
+                        header[15] = static_cast<std::uint8_t>(height >> 8);
+                        header[16] = static_cast<std::uint8_t>(bytes * 8);
+                        // top-down, alpha bits
+                        header[17] = static_cast<std::uint8_t>(0x20 | (alpha ? 8 : 0));
+                        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+                        std::vector<std::uint8_t> row(width * bytes);
+                        for (size_t y = 0; y < height; ++y)
+                        {
+                            for (size_t x = 0; x < width; ++x)
+                            {
+                                const T* pixel = view.pixel(x, y);
+                                std::uint8_t* dst = &row[x * bytes];
+                                dst[0] = static_cast<std::uint8_t>(load_channel_byte(view, pixel, 2));
+                                dst[1] = static_cast<std::uint8_t>(load_channel_byte(view, pixel, 1));
+                                dst[2] = static_cast<std::uint8_t>(load_channel_byte(view, pixel, 0));
+                                if (alpha)
+                                {
+                                    dst[3] = static_cast<std::uint8_t>(load_channel_byte(view, pixel, 3));
+                                }
+                            }
+                            out.write(reinterpret_cast<const char*>(row.data()), row.size());
+                        }
+                    }
+                    break;
+                case format_png:
+                    {
+                        if (width > 0x7fffffffu || height > 0x7fffffffu)
+                        {
+                            return false;
+                        }
+                        static const std::uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+                        out.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+                        const size_t bpp = alpha ? 4 : 3;
+                        std::uint8_t ihdr[13] = {};
+                        put_be32(ihdr, static_cast<std::uint32_t>(width));
+                        put_be32(ihdr + 4, static_cast<std::uint32_t>(height));
+                        ihdr[8] = 8;
+                        ihdr[9] = alpha ? 6 : 2;
+                        write_png_chunk(out, "IHDR", ihdr, sizeof(ihdr));
+
+                        png_idat_writer idat = { out, std::vector<std::uint8_t>() };
+                        detail::deflate::deflater<png_idat_writer> deflater(idat);
+
+                        // each row gets the filter with the smallest sum of (signed) residuals, the usual
+                        // heuristic; 0 is none, then sub, up, average and paeth
+                        const size_t bytes = width * bpp;
+                        std::vector<std::uint8_t> previous(bytes, 0);
+                        std::vector<std::uint8_t> current(bytes);
+                        std::vector<std::uint8_t> filtered[5];
+                        for (auto& f : filtered)
+                        {
+                            f.resize(bytes + 1);
+                        }
+
+                        for (size_t y = 0; y < height; ++y)
+                        {
+                            for (size_t x = 0; x < width; ++x)
+                            {
+                                const T* pixel = view.pixel(x, y);
+                                for (size_t c = 0; c < bpp; ++c)
+                                {
+                                    current[x * bpp + c] = static_cast<std::uint8_t>(load_channel_byte(view, pixel, static_cast<int>(c)));
+                                }
+                            }
+
+                            size_t best = 0;
+                            size_t best_cost = static_cast<size_t>(-1);
+                            for (unsigned f = 0; f < 5; ++f)
+                            {
+                                std::uint8_t* dst = filtered[f].data();
+                                dst[0] = static_cast<std::uint8_t>(f);
+                                size_t cost = 0;
+                                for (size_t i = 0; i < bytes; ++i)
+                                {
+                                    const unsigned left = i >= bpp ? current[i - bpp] : 0;
+                                    const unsigned up = previous[i];
+                                    const unsigned corner = i >= bpp ? previous[i - bpp] : 0;
+                                    unsigned predicted = 0;
+                                    switch (f)
+                                    {
+                                    case 1:
+                                        predicted = left;
+                                        break;
+                                    case 2:
+                                        predicted = up;
+                                        break;
+                                    case 3:
+                                        predicted = (left + up) >> 1;
+                                        break;
+                                    case 4:
+                                        predicted = paeth(left, up, corner);
+                                        break;
+                                    }
+                                    const std::uint8_t residual = static_cast<std::uint8_t>(current[i] - predicted);
+                                    dst[i + 1] = residual;
+                                    cost += residual < 128 ? residual : 256 - residual;
+                                }
+                                if (cost < best_cost)
+                                {
+                                    best = f;
+                                    best_cost = cost;
+                                }
+                            }
+
+                            deflater.write(filtered[best].data(), filtered[best].size());
+                            current.swap(previous);
+                        }
+
+                        deflater.finish();
+                        idat.flush();
+                        write_png_chunk(out, "IEND", nullptr, 0);
+                    }
+                    break;
+                default:
+                    return false;
+                }
+                return !out.fail();
+            }
+
+            template <class T>
+            bool write(std::ostream& out, file_format format, const image_view<T>& view)
+            {
+                const image_view<const T> constant = { view.data, view.width, view.height, view.pitch, view.stride, { view.channels[0], view.channels[1], view.channels[2], view.channels[3] } };
+                return write(out, format, constant);
+            }
+
+            //! Decodes an image straight into the RGBA floats a sampler builds its levels from, in OpenGL's
+            //! bottom-up row order, and assigns it.
+            template <class Sampler>
+            bool read_texture(std::istream& in, Sampler& sampler, typename Sampler::texel_layout layout, typename Sampler::texel_format format)
+            {
+                reader r(in);
+                std::vector<float> rgba;
+                if (!r.read_rgba(rgba, true))
+                {
+                    return false;
+                }
+                sampler.assign(r.width(), r.height(), std::move(rgba), layout, format);
+                return true;
+            }
+
+            //! As above; HDR images get a half float format, others RGBA8.
+            template <class Sampler>
+            bool read_texture(std::istream& in, Sampler& sampler)
+            {
+                reader r(in);
+                std::vector<float> rgba;
+                if (!r.read_rgba(rgba, true))
+                {
+                    return false;
+                }
+                sampler.assign(r.width(), r.height(), std::move(rgba), Sampler::default_layout, r.hdr() ? Sampler::format_rgba16f : Sampler::format_rgba8);
+                return true;
+            }
+        }
+    }
+}
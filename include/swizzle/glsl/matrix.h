@@ -214,13 +214,16 @@ namespace swizzle
             }
 
             //! Matrix-vector multiplication.
+            //! Done by broadcasting v's components over whole columns (result = sum(column(i) * v[i])),
+            //! so that there's no need to gather strided row data. This is a win for both plain
+            //! scalars and SIMD scalars, where each column is a bunch of registers already.
             static column_type mul(const matrix_type& m, const row_type& v)
             {
-                column_type result;
+                column_type result = m.column(0) * v[0];
 
-                detail::static_for<0, N>([&](size_t row) -> void
+                detail::static_for<1, M>([&](size_t col) -> void
                 {
-                    result[row] = v.call_dot(v, m.row(row));
+                    result += m.column(col) * v[col];
                 });
 
                 return result;
@@ -253,6 +256,44 @@ namespace swizzle
                 return result;
             }
 
+        // GLSL FUNCTIONS
+        // Friends, so that ADL finds them for unqualified calls in the shader code.
+        public:
+
+            friend matrix<VectorType, ScalarType, M, N> transpose(const matrix& m)
+            {
+                matrix<VectorType, ScalarType, M, N> result;
+                detail::static_for<0, M>([&](size_t col) -> void
+                {
+                    for (size_t row = 0; row < N; ++row)
+                    {
+                        result.cell(col, row) = m.cell(row, col);
+                    }
+                });
+                return result;
+            }
+
+            friend matrix matrixCompMult(const matrix& a, const matrix& b)
+            {
+                matrix result;
+                detail::static_for<0, M>([&](size_t col) -> void { result[col] = a[col] * b[col]; });
+                return result;
+            }
+
+            //! Closed-form for 2x2, 3x3 and 4x4; no branches, so works per lane for SIMD scalars.
+            friend scalar_type determinant(const matrix& m)
+            {
+                static_assert(N == M, "determinant is only defined for square matrices");
+                return determinant_impl(m, std::integral_constant<size_t, N>());
+            }
+
+            //! As above. Singular matrices produce infs/NaNs, as division by zero happens.
+            friend matrix inverse(const matrix& m)
+            {
+                static_assert(N == M, "inverse is only defined for square matrices");
+                return inverse_impl(m, std::integral_constant<size_t, N>());
+            }
+
         private:
 
             template <size_t offset, class T0, class... Tail>
@@ -289,6 +330,108 @@ namespace swizzle
                 cell( CellIdx % N, CellIdx / N ) = s;
             }
 
+            static scalar_type determinant_impl(const matrix& m, std::integral_constant<size_t, 2>)
+            {
+                return m[0][0] * m[1][1] - m[1][0] * m[0][1];
+            }
+
+            static scalar_type determinant_impl(const matrix& m, std::integral_constant<size_t, 3>)
+            {
+                return column_type::call_dot(m[0], column_type::call_cross(m[1], m[2]));
+            }
+
+            static scalar_type determinant_impl(const matrix& m, std::integral_constant<size_t, 4>)
+            {
+                // Laplace expansion using 2x2 sub-determinants of the first two and the last two columns
+                scalar_type s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+                scalar_type s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+                scalar_type s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+                scalar_type s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+                scalar_type s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+                scalar_type s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+                scalar_type c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+                scalar_type c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+                scalar_type c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+                scalar_type c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+                scalar_type c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+                scalar_type c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+                return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+            }
+
+            static matrix inverse_impl(const matrix& m, std::integral_constant<size_t, 2>)
+            {
+                scalar_type invDet = scalar_type(1) / determinant_impl(m, std::integral_constant<size_t, 2>());
+                matrix result;
+                result[0][0] = m[1][1] * invDet;
+                result[0][1] = -m[0][1] * invDet;
+                result[1][0] = -m[1][0] * invDet;
+                result[1][1] = m[0][0] * invDet;
+                return result;
+            }
+
+            static matrix inverse_impl(const matrix& m, std::integral_constant<size_t, 3>)
+            {
+                // rows of the inverse are cross products of columns
+                column_type r0 = column_type::call_cross(m[1], m[2]);
+                column_type r1 = column_type::call_cross(m[2], m[0]);
+                column_type r2 = column_type::call_cross(m[0], m[1]);
+                scalar_type invDet = scalar_type(1) / column_type::call_dot(m[0], r0);
+
+                matrix result;
+                detail::static_for<0, 3>([&](size_t col) -> void
+                {
+                    result[col][0] = r0[col] * invDet;
+                    result[col][1] = r1[col] * invDet;
+                    result[col][2] = r2[col] * invDet;
+                });
+                return result;
+            }
+
+            static matrix inverse_impl(const matrix& m, std::integral_constant<size_t, 4>)
+            {
+                // same sub-determinants as in determinant_impl; the expansion is symmetric, hence
+                // it doesn't matter that m[col][row] is used
+                scalar_type s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+                scalar_type s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+                scalar_type s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+                scalar_type s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+                scalar_type s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+                scalar_type s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+                scalar_type c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+                scalar_type c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+                scalar_type c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+                scalar_type c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+                scalar_type c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+                scalar_type c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+                scalar_type invDet = scalar_type(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+                matrix result;
+                result[0][0] = ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invDet;
+                result[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invDet;
+                result[0][2] = ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invDet;
+                result[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invDet;
+
+                result[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invDet;
+                result[1][1] = ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invDet;
+                result[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invDet;
+                result[1][3] = ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invDet;
+
+                result[2][0] = ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invDet;
+                result[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invDet;
+                result[2][2] = ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invDet;
+                result[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invDet;
+
+                result[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invDet;
+                result[3][1] = ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invDet;
+                result[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invDet;
+                result[3][3] = ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invDet;
+                return result;
+            }
+
         private:
             std::array< column_type, M > m_data; 
         };
@@ -298,5 +441,14 @@ namespace swizzle
         {
             return m1.mul(m1, m2);
         }
+
+        //! GLSL's outerProduct: c * r^T, c being a column and r a row.
+        template <template <class, size_t> class VectorType, class ScalarType, size_t N, size_t M>
+        matrix<VectorType, ScalarType, N, M> outerProduct(const VectorType<ScalarType, N>& c, const VectorType<ScalarType, M>& r)
+        {
+            matrix<VectorType, ScalarType, N, M> result;
+            detail::static_for<0, M>([&](size_t col) -> void { result[col] = c * r[col]; });
+            return result;
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,184 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define CXXSWIZZLE_PIXEL_PACKING_SSSE3
+#endif
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! Byte order of framebuffer pixels, in memory; rgba is packUnorm4x8's.
+        enum pixel_format
+        {
+            pixel_rgb24,
+            pixel_bgr24,
+            pixel_rgba32,
+            pixel_bgra32
+        };
+
+        inline size_t pixel_size(pixel_format format)
+        {
+            return format == pixel_rgb24 || format == pixel_bgr24 ? 3 : 4;
+        }
+    }
+
+    namespace detail
+    {
+        namespace pixel_packing
+        {
+            //! Lowest byte first, unaligned.
+            inline void store32(std::uint8_t* dst, std::uint32_t value)
+            {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                dst[0] = static_cast<std::uint8_t>(value);
+                dst[1] = static_cast<std::uint8_t>(value >> 8);
+                dst[2] = static_cast<std::uint8_t>(value >> 16);
+                dst[3] = static_cast<std::uint8_t>(value >> 24);
+#else
+                // a single store; compilers do not always merge the bytes above
+                std::memcpy(dst, &value, sizeof(value));
+#endif
+            }
+
+            inline std::uint32_t swap_red_blue(std::uint32_t c)
+            {
+                return (c & 0xff00ff00u) | ((c >> 16) & 0xffu) | ((c & 0xffu) << 16);
+            }
+
+            template <bool Swap>
+            inline std::uint32_t order(std::uint32_t c)
+            {
+                return Swap ? swap_red_blue(c) : c;
+            }
+
+            //! Without SIMD: words in, words out; 24 bit pixels go 4 to 3 words.
+            template <bool Swap>
+            inline void pack24(const std::uint32_t* src, size_t count, std::uint8_t* dst)
+            {
+                const size_t blocks = count / 4;
+                for (size_t block = 0; block < blocks; ++block, src += 4, dst += 12)
+                {
+                    const std::uint32_t p0 = order<Swap>(src[0]), p1 = order<Swap>(src[1]), p2 = order<Swap>(src[2]), p3 = order<Swap>(src[3]);
+                    store32(dst, (p0 & 0xffffffu) | (p1 << 24));
+                    store32(dst + 4, ((p1 >> 8) & 0xffffu) | (p2 << 16));
+                    store32(dst + 8, ((p2 >> 16) & 0xffu) | (p3 << 8));
+                }
+                for (size_t i = 0; i < count % 4; ++i, ++src, dst += 3)
+                {
+                    const std::uint32_t p = order<Swap>(*src);
+                    dst[0] = static_cast<std::uint8_t>(p);
+                    dst[1] = static_cast<std::uint8_t>(p >> 8);
+                    dst[2] = static_cast<std::uint8_t>(p >> 16);
+                }
+            }
+
+            template <bool Swap>
+            inline void pack32(const std::uint32_t* src, size_t count, std::uint8_t* dst)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    store32(dst + i * 4, order<Swap>(src[i]));
+                }
+            }
+
+            inline void pack(const std::uint32_t* src, size_t count, swizzle::glsl::pixel_format format, std::uint8_t* dst)
+            {
+                switch (format)
+                {
+                case swizzle::glsl::pixel_rgb24:
+                    pack24<false>(src, count, dst);
+                    break;
+                case swizzle::glsl::pixel_bgr24:
+                    pack24<true>(src, count, dst);
+                    break;
+                case swizzle::glsl::pixel_rgba32:
+                    pack32<false>(src, count, dst);
+                    break;
+                default:
+                    pack32<true>(src, count, dst);
+                    break;
+                }
+            }
+
+#ifdef CXXSWIZZLE_PIXEL_PACKING_SSSE3
+            //! A pshufb per 4 pixels; 24 bit ones come out in the low 12 bytes.
+            inline __m128i shuffle_mask(swizzle::glsl::pixel_format format)
+            {
+                switch (format)
+                {
+                case swizzle::glsl::pixel_rgb24:
+                    return _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+                case swizzle::glsl::pixel_bgr24:
+                    return _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+                case swizzle::glsl::pixel_bgra32:
+                    return _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+                default:
+                    return _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+                }
+            }
+
+            //! Returns how many pixels are left for pack().
+            inline size_t pack_ssse3(const std::uint32_t* src, size_t count, swizzle::glsl::pixel_format format, std::uint8_t* dst)
+            {
+                const __m128i mask = shuffle_mask(format);
+                size_t i = 0;
+                if (swizzle::glsl::pixel_size(format) == 4)
+                {
+                    for (; i + 4 <= count; i += 4)
+                    {
+                        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_shuffle_epi8(p, mask));
+                    }
+                    return count - i;
+                }
+
+                // 16 pixels are exactly 3 stores
+                for (; i + 16 <= count; i += 16)
+                {
+                    const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), mask);
+                    const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), mask);
+                    const __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)), mask);
+                    const __m128i d = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)), mask);
+                    __m128i* out = reinterpret_cast<__m128i*>(dst + i * 3);
+                    _mm_storeu_si128(out, _mm_or_si128(a, _mm_slli_si128(b, 12)));
+                    _mm_storeu_si128(out + 1, _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+                    _mm_storeu_si128(out + 2, _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+                }
+                // 4 pixels are 8 + 4 bytes
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), mask);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 3), a);
+                    store32(dst + i * 3 + 8, static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(a, 8))));
+                }
+                return count - i;
+            }
+#endif
+        }
+    }
+
+    namespace glsl
+    {
+        //! Writes count colours in packUnorm4x8 layout (R in the lowest byte) to consecutive pixels of a
+        //! framebuffer; neither needs to be aligned. With SSSE3 (or AVX) enabled, pixels are shuffled 4
+        //! at a time and 24 bit ones written 16 bytes at a time.
+        inline void pack_pixels(const std::uint32_t* src, size_t count, pixel_format format, std::uint8_t* dst)
+        {
+#ifdef CXXSWIZZLE_PIXEL_PACKING_SSSE3
+            const size_t left = detail::pixel_packing::pack_ssse3(src, count, format, dst);
+            const size_t done = count - left;
+            detail::pixel_packing::pack(src + done, left, format, dst + done * pixel_size(format));
+#else
+            detail::pixel_packing::pack(src, count, format, dst);
+#endif
+        }
+    }
+}
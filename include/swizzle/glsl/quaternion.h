@@ -0,0 +1,201 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <swizzle/glsl/vector.h>
+#include <swizzle/glsl/matrix.h>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! A rotation quaternion; (x, y, z) is the vector part and w the scalar one. It is a vec4, so swizzles
+        //! keep working; other vector functions need an explicit vec4 conversion.
+        //! None of the functions branch, so SIMD scalar types (vc_float) rotate/interpolate a quaternion
+        //! per lane.
+        template <class ScalarType>
+        class quat : public vector<ScalarType, 4>
+        {
+        public:
+            typedef ScalarType scalar_type;
+            typedef const scalar_type& scalar_arg_type;
+            typedef vector<ScalarType, 3> vec3_type;
+            typedef vector<ScalarType, 4> vec4_type;
+            typedef matrix<vector, ScalarType, 3, 3> mat3_type;
+
+        // CONSTRUCTION
+        public:
+
+            //! Identity.
+            quat()
+                : vec4_type(scalar_type(0), scalar_type(0), scalar_type(0), scalar_type(1))
+            {}
+
+            quat(scalar_arg_type x, scalar_arg_type y, scalar_arg_type z, scalar_arg_type w)
+                : vec4_type(x, y, z, w)
+            {}
+
+            quat(const vec3_type& xyz, scalar_arg_type w)
+                : vec4_type(xyz, w)
+            {}
+
+            explicit quat(const vec4_type& v)
+                : vec4_type(v)
+            {}
+
+            //! From a rotation matrix (orthonormal, no scaling). Shepperd's method: all four candidates
+            //! are computed and the most accurate is selected, without branching.
+            explicit quat(const mat3_type& m)
+            {
+                using namespace std;
+
+                // m[col][row]
+                scalar_type t0 = 1.0f + m[0][0] + m[1][1] + m[2][2];
+                scalar_type t1 = 1.0f + m[0][0] - m[1][1] - m[2][2];
+                scalar_type t2 = 1.0f - m[0][0] + m[1][1] - m[2][2];
+                scalar_type t3 = 1.0f - m[0][0] - m[1][1] + m[2][2];
+
+                scalar_type sx = m[1][2] - m[2][1];
+                scalar_type sy = m[2][0] - m[0][2];
+                scalar_type sz = m[0][1] - m[1][0];
+                scalar_type xy = m[1][0] + m[0][1];
+                scalar_type xz = m[2][0] + m[0][2];
+                scalar_type yz = m[2][1] + m[1][2];
+
+                // the largest t is at least 1, others only need to stay finite so that 0 * candidate == 0
+                const scalar_type min_t(1e-6f);
+                vec4_type c0 = vec4_type(sx, sy, sz, t0) * (0.5f / sqrt(max(t0, min_t)));
+                vec4_type c1 = vec4_type(t1, xy, xz, sx) * (0.5f / sqrt(max(t1, min_t)));
+                vec4_type c2 = vec4_type(xy, t2, yz, sy) * (0.5f / sqrt(max(t2, min_t)));
+                vec4_type c3 = vec4_type(xz, yz, t3, sz) * (0.5f / sqrt(max(t3, min_t)));
+
+                // exactly one of these is 1
+                scalar_type s0 = step(t1, t0) * step(t2, t0) * step(t3, t0);
+                scalar_type s1 = (1.0f - s0) * step(t2, t1) * step(t3, t1);
+                scalar_type s2 = (1.0f - s0) * (1.0f - s1) * step(t3, t2);
+                scalar_type s3 = (1.0f - s0) * (1.0f - s1) * (1.0f - s2);
+
+                vec4_type::operator=(c0 * s0 + c1 * s1 + c2 * s2 + c3 * s3);
+            }
+
+            //! Rotation by angle (radians) around a unit axis.
+            static quat angle_axis(scalar_arg_type angle, const vec3_type& axis)
+            {
+                using namespace std;
+                scalar_type half = angle * 0.5f;
+                return quat(axis * sin(half), cos(half));
+            }
+
+        // UTILITY FUNCTIONS
+        public:
+
+            mat3_type to_mat3() const
+            {
+                scalar_type x = this->at(0), y = this->at(1), z = this->at(2), w = this->at(3);
+                scalar_type xx = x * x, yy = y * y, zz = z * z;
+                scalar_type xy = x * y, xz = x * z, yz = y * z;
+                scalar_type wx = w * x, wy = w * y, wz = w * z;
+
+                mat3_type result;
+                result[0] = vec3_type(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy));
+                result[1] = vec3_type(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx));
+                result[2] = vec3_type(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+                return result;
+            }
+
+        // OPERATORS
+        public:
+
+            //! Hamilton product; the result applies b first, then a (same as matrices).
+            friend quat operator*(const quat& a, const quat& b)
+            {
+                vec3_type av = a.xyz_part(), bv = b.xyz_part();
+                vec3_type v = bv * a.at(3) + av * b.at(3) + vec3_type::call_cross(av, bv);
+                return quat(v, a.at(3) * b.at(3) - vec3_type::call_dot(av, bv));
+            }
+
+            quat& operator*=(const quat& other)
+            {
+                return *this = *this * other;
+            }
+
+        // FUNCTIONS
+        public:
+
+            friend scalar_type dot(const quat& a, const quat& b)
+            {
+                return vec4_type::call_dot(a, b);
+            }
+
+            friend scalar_type length(const quat& q)
+            {
+                return vec4_type::call_length(q);
+            }
+
+            friend quat conjugate(const quat& q)
+            {
+                return quat(-q.xyz_part(), q.at(3));
+            }
+
+            friend quat inverse(const quat& q)
+            {
+                return quat(vec4_type(conjugate(q)) / vec4_type::call_dot(q, q));
+            }
+
+            friend quat normalize(const quat& q)
+            {
+                return quat(vec4_type::call_normalize(q));
+            }
+
+            //! Rotates v by a unit quaternion: v + w * t + cross(q.xyz, t), t = 2 * cross(q.xyz, v),
+            //! i.e. 15 multiplies instead of two quaternion products.
+            friend vec3_type rotate(const quat& q, const vec3_type& v)
+            {
+                vec3_type qv = q.xyz_part();
+                vec3_type t = vec3_type::call_cross(qv, v) * 2.0f;
+                return v + t * q.at(3) + vec3_type::call_cross(qv, t);
+            }
+
+            //! Normalised linear interpolation along the shorter arc; cheaper than slerp, non-constant velocity.
+            friend quat nlerp(const quat& a, const quat& b, scalar_arg_type t)
+            {
+                vec4_type bb = vec4_type(b) * shorter_arc_sign(a, b);
+                return normalize(quat(vec4_type(a) + (bb - vec4_type(a)) * t));
+            }
+
+            //! Spherical linear interpolation along the shorter arc; falls back to a linear blend
+            //! for nearly identical quaternions, where sin(angle) would divide by ~0.
+            friend quat slerp(const quat& a, const quat& b, scalar_arg_type t)
+            {
+                using namespace std;
+
+                scalar_type sign = shorter_arc_sign(a, b);
+                scalar_type d = min(vec4_type::call_dot(a, b) * sign, scalar_type(1.0f));
+
+                scalar_type angle = acos(d);
+                scalar_type sin_angle = sqrt(1.0f - d * d);
+                scalar_type inv_sin_angle = 1.0f / max(sin_angle, scalar_type(1e-6f));
+
+                // linear is exactly 0 or 1, so that the unused branch does not leak in
+                scalar_type linear = step(scalar_type(1.0f - 1e-5f), d);
+                scalar_type wa = linear * (1.0f - t) + (1.0f - linear) * sin((1.0f - t) * angle) * inv_sin_angle;
+                scalar_type wb = linear * t + (1.0f - linear) * sin(t * angle) * inv_sin_angle;
+
+                return quat(vec4_type(a) * wa + vec4_type(b) * (wb * sign));
+            }
+
+        private:
+            vec3_type xyz_part() const
+            {
+                return vec3_type(this->at(0), this->at(1), this->at(2));
+            }
+
+            //! 1 or -1; q and -q are the same rotation, so b is flipped if it is on the other side of a.
+            static scalar_type shorter_arc_sign(const quat& a, const quat& b)
+            {
+                using namespace std;
+                return step(scalar_type(0.0f), vec4_type::call_dot(a, b)) * 2.0f - 1.0f;
+            }
+        };
+    }
+}
@@ -0,0 +1,115 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <swizzle/detail/vector_traits.h>
+#include <swizzle/glsl/vector.h>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! A counter-based random number generator for Monte Carlo shaders, a replacement for the
+        //! fract(sin(dot(...)) * 43758.5453) idiom. The whole state is one unsigned integer per lane:
+        //! each call advances a Weyl sequence and returns its hash, so there are no branches, no tables
+        //! and nothing shared between lanes or threads.
+        //! FloatType needs get_uint_scalar_type specialised (scalar_support.h and simd_support_vc.h do that).
+        template <class FloatType>
+        class random_generator
+        {
+        public:
+            typedef FloatType float_type;
+            typedef typename detail::get_uint_scalar_type<FloatType>::type uint_type;
+            typedef vector<float_type, 2> vec2_type;
+            typedef vector<float_type, 3> vec3_type;
+
+            explicit random_generator(const uint_type& seed)
+                : m_state(hash(seed))
+            {}
+
+            //! Gives each pixel (lane) its own stream; passing a different frame index
+            //! every frame makes the noise change over time.
+            random_generator(const vec2_type& fragCoord, unsigned frame)
+                : m_state(hash(uint_type(fragCoord[0]) ^ hash(uint_type(fragCoord[1]) ^ hash(uint_type(frame)))))
+            {}
+
+            uint_type next_uint()
+            {
+                m_state += 0x9e3779b9u;
+                return hash(m_state);
+            }
+
+            //! Uniform in [0, 1); uses top 24 bits, so that the conversion is exact.
+            float_type next_float()
+            {
+                return float_type(next_uint() >> 8) * (1.0f / 16777216.0f);
+            }
+
+            template <size_t Size>
+            vector<float_type, Size> next_vec()
+            {
+                vector<float_type, Size> result;
+                for (size_t i = 0; i < Size; ++i)
+                {
+                    result[i] = next_float();
+                }
+                return result;
+            }
+
+            //! Uniform in the unit disk.
+            vec2_type disk()
+            {
+                using namespace std;
+                float_type r = sqrt(next_float());
+                float_type phi = next_float() * two_pi();
+                return vec2_type(r * cos(phi), r * sin(phi));
+            }
+
+            //! Uniform on the unit sphere.
+            vec3_type sphere()
+            {
+                using namespace std;
+                float_type z = 1.0f - 2.0f * next_float();
+                float_type r = sqrt(max(1.0f - z * z, float_type(0.0f)));
+                float_type phi = next_float() * two_pi();
+                return vec3_type(r * cos(phi), r * sin(phi), z);
+            }
+
+            //! Uniform on the unit hemisphere around n; a sphere sample is flipped if it points
+            //! the other way, which keeps lanes coherent.
+            vec3_type hemisphere(const vec3_type& n)
+            {
+                using namespace std;
+                vec3_type d = sphere();
+                float_type flip = step(float_type(0.0f), vec3_type::call_dot(d, n)) * 2.0f - 1.0f;
+                return d * flip;
+            }
+
+            //! Cosine-weighted on the unit hemisphere around n (unit length expected); this is
+            //! the distribution ambient occlusion and diffuse bounces want.
+            vec3_type cosine_hemisphere(const vec3_type& n)
+            {
+                return vec3_type::call_normalize(n + sphere());
+            }
+
+        private:
+            uint_type m_state;
+
+            //! "lowbias32" integer hash by Chris Wellons.
+            static uint_type hash(uint_type x)
+            {
+                x ^= x >> 16;
+                x *= 0x7feb352du;
+                x ^= x >> 15;
+                x *= 0x846ca68bu;
+                x ^= x >> 16;
+                return x;
+            }
+
+            static float_type two_pi()
+            {
+                return float_type(6.28318530717958647692f);
+            }
+        };
+    }
+}
@@ -3,7 +3,10 @@
 #pragma once
 
 #include <swizzle/detail/vector_traits.h>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 
 namespace swizzle
 {
@@ -49,6 +52,79 @@ namespace swizzle
         template <>
         struct get_vector_type_impl<unsigned short> : get_vector_type_impl_for_scalar<unsigned short>
         {};
+
+
+        template <>
+        struct get_int_scalar_type<float>
+        {
+            typedef int type;
+        };
+
+        template <>
+        struct get_int_scalar_type<double>
+        {
+            typedef int type;
+        };
+
+        template <>
+        struct get_uint_scalar_type<float>
+        {
+            typedef unsigned type;
+        };
+
+        template <>
+        struct get_float_scalar_type<unsigned>
+        {
+            typedef float type;
+        };
+
+        template <>
+        struct batch_traits<float>
+        {
+            static const size_t size = 1;
+            static const size_t alignment = sizeof(float);
+
+            static float load(const float* p)
+            {
+                return *p;
+            }
+            static void store(float v, float* p)
+            {
+                *p = v;
+            }
+            template <size_t N>
+            static void load_interleaved(const float* p, float (&v)[N])
+            {
+                std::copy(p, p + N, v);
+            }
+            template <size_t N>
+            static void store_interleaved(const float (&v)[N], float* p)
+            {
+                std::copy(v, v + N, p);
+            }
+            static void stream(float v, float* p)
+            {
+                *p = v;
+            }
+            static void stream_fence()
+            {}
+            static unsigned load(const std::uint32_t* p)
+            {
+                return *p;
+            }
+            static void store(unsigned v, std::uint32_t* p)
+            {
+                *p = v;
+            }
+            static std::uint32_t gather(const std::uint32_t* p, unsigned index)
+            {
+                return p[index];
+            }
+            static float gather(const float* p, unsigned index)
+            {
+                return p[index];
+            }
+        };
     }
 }
 
@@ -75,4 +151,145 @@ namespace std
     {
         return x - floor(x);
     }
+
+    inline float roundEven(float x)
+    {
+        // with the default rounding mode this breaks ties to even
+        return nearbyint(x);
+    }
+
+    // packing functions; SIMD counterparts live in simd_support_*.h and are meant to give
+    // same results bit by bit
+
+    inline unsigned packUnorm4x8(float x, float y, float z, float w)
+    {
+        auto c = [](float v) -> unsigned { return static_cast<unsigned>(nearbyint(fmin(fmax(v, 0.0f), 1.0f) * 255.0f)); };
+        return c(x) | (c(y) << 8) | (c(z) << 16) | (c(w) << 24);
+    }
+
+    inline unsigned packSnorm4x8(float x, float y, float z, float w)
+    {
+        auto c = [](float v) -> unsigned { return static_cast<unsigned>(static_cast<int>(nearbyint(fmin(fmax(v, -1.0f), 1.0f) * 127.0f))) & 0xff; };
+        return c(x) | (c(y) << 8) | (c(z) << 16) | (c(w) << 24);
+    }
+
+    inline unsigned packUnorm2x16(float x, float y)
+    {
+        auto c = [](float v) -> unsigned { return static_cast<unsigned>(nearbyint(fmin(fmax(v, 0.0f), 1.0f) * 65535.0f)); };
+        return c(x) | (c(y) << 16);
+    }
+
+    inline unsigned packSnorm2x16(float x, float y)
+    {
+        auto c = [](float v) -> unsigned { return static_cast<unsigned>(static_cast<int>(nearbyint(fmin(fmax(v, -1.0f), 1.0f) * 32767.0f))) & 0xffff; };
+        return c(x) | (c(y) << 16);
+    }
+
+    inline void unpackUnorm4x8(unsigned p, float* x, float* y, float* z, float* w)
+    {
+        *x = static_cast<float>(p & 0xff) / 255.0f;
+        *y = static_cast<float>((p >> 8) & 0xff) / 255.0f;
+        *z = static_cast<float>((p >> 16) & 0xff) / 255.0f;
+        *w = static_cast<float>(p >> 24) / 255.0f;
+    }
+
+    inline void unpackSnorm4x8(unsigned p, float* x, float* y, float* z, float* w)
+    {
+        auto c = [](unsigned v) -> float { return fmax(static_cast<float>(static_cast<int8_t>(v & 0xff)) / 127.0f, -1.0f); };
+        *x = c(p);
+        *y = c(p >> 8);
+        *z = c(p >> 16);
+        *w = c(p >> 24);
+    }
+
+    inline void unpackUnorm2x16(unsigned p, float* x, float* y)
+    {
+        *x = static_cast<float>(p & 0xffff) / 65535.0f;
+        *y = static_cast<float>(p >> 16) / 65535.0f;
+    }
+
+    inline void unpackSnorm2x16(unsigned p, float* x, float* y)
+    {
+        auto c = [](unsigned v) -> float { return fmax(static_cast<float>(static_cast<int16_t>(v & 0xffff)) / 32767.0f, -1.0f); };
+        *x = c(p);
+        *y = c(p >> 16);
+    }
+
+    //! Round-to-nearest-even float to half conversion (after Fabian Giesen's float_to_half_fast3_rtne)
+    inline unsigned packHalf2x16(float x, float y)
+    {
+        auto c = [](float v) -> unsigned
+        {
+            const uint32_t f32infty = 255u << 23;
+            const uint32_t f16max = (127u + 16u) << 23;
+            const uint32_t denormMagicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+            float denormMagic;
+            memcpy(&denormMagic, &denormMagicBits, sizeof(float));
+
+            uint32_t u;
+            memcpy(&u, &v, sizeof(float));
+            uint32_t sign = u & 0x80000000u;
+            u ^= sign;
+
+            uint32_t result;
+            if (u >= f16max)
+            {
+                // Inf or NaN
+                result = (u > f32infty) ? 0x7e00 : 0x7c00;
+            }
+            else if (u < (113u << 23))
+            {
+                // subnormal or zero; let the FPU do the rounding
+                float f;
+                memcpy(&f, &u, sizeof(float));
+                f += denormMagic;
+                memcpy(&result, &f, sizeof(float));
+                result -= denormMagicBits;
+            }
+            else
+            {
+                uint32_t mantOdd = (u >> 13) & 1;
+                result = (u + (static_cast<uint32_t>(15 - 127) << 23) + 0xfff + mantOdd) >> 13;
+            }
+            return result | (sign >> 16);
+        };
+        return c(x) | (c(y) << 16);
+    }
+
+    inline void unpackHalf2x16(unsigned p, float* x, float* y)
+    {
+        auto c = [](unsigned h) -> float
+        {
+            const uint32_t shiftedExp = 0x7c00u << 13;
+            const uint32_t magicBits = 113u << 23;
+            float magic;
+            memcpy(&magic, &magicBits, sizeof(float));
+
+            uint32_t o = (h & 0x7fff) << 13;
+            uint32_t exp = o & shiftedExp;
+            o += (127u - 15u) << 23;
+
+            if (exp == shiftedExp)
+            {
+                // Inf or NaN
+                o += (128u - 16u) << 23;
+            }
+            else if (exp == 0)
+            {
+                // zero or subnormal, renormalise
+                o += 1u << 23;
+                float f;
+                memcpy(&f, &o, sizeof(float));
+                f -= magic;
+                memcpy(&o, &f, sizeof(float));
+            }
+
+            o |= (h & 0x8000) << 16;
+            float result;
+            memcpy(&result, &o, sizeof(float));
+            return result;
+        };
+        *x = c(p & 0xffff);
+        *y = c(p >> 16);
+    }
 }
\ No newline at end of file
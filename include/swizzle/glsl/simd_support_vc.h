@@ -4,9 +4,13 @@
 
 // VC needs to come first or else it's going to complain (damn I hate these)
 #include <Vc/vector.h>
+#include <Vc/Memory>
 #include <type_traits>
+#include <limits>
 #include <swizzle/detail/primitive_wrapper.h>
 #include <swizzle/glsl/vector_helper.h>
+// scalar versions of GLSL functions are what lane_map falls back to
+#include <swizzle/glsl/scalar_support.h>
 
 
 namespace swizzle
@@ -15,8 +19,12 @@ namespace swizzle
     {
 #ifdef VC_UNCONDITIONAL_AVX2_INTRINSICS
         typedef ::Vc::float_v::VectorType::Base raw_simd_type;
+        typedef ::Vc::int_v::VectorType::Base raw_simd_int_type;
+        typedef ::Vc::uint_v::VectorType::Base raw_simd_uint_type;
 #else
         typedef ::Vc::float_v::VectorType raw_simd_type;
+        typedef ::Vc::int_v::VectorType raw_simd_int_type;
+        typedef ::Vc::uint_v::VectorType raw_simd_uint_type;
 #endif
 
         //! ::Vc::float_v has a tiny bit different semantics than what we need,
@@ -24,31 +32,52 @@ namespace swizzle
         template<typename BoolType = ::Vc::float_m, typename AssignPolicy = detail::nothing>
         using vc_float = detail::primitive_wrapper < ::Vc::float_v, ::Vc::float_v::EntryType, BoolType, AssignPolicy >;
 
+        //! Integer counterpart of vc_float (GLSL's genIType), needed by functions such as frexp and ldexp.
+        template<typename BoolType = ::Vc::int_m, typename AssignPolicy = detail::nothing>
+        using vc_int = detail::primitive_wrapper < ::Vc::int_v, ::Vc::int_v::EntryType, BoolType, AssignPolicy >;
 
-        //! Specialise vector_helper so that it knows what to do.
-        template <typename BoolType, typename AssignPolicy, size_t Size>
-        struct vector_helper<vc_float<BoolType, AssignPolicy>, Size>
+        //! Unsigned counterpart of vc_float (GLSL's genUType), used by packing functions.
+        template<typename BoolType = ::Vc::uint_m, typename AssignPolicy = detail::nothing>
+        using vc_uint = detail::primitive_wrapper < ::Vc::uint_v, ::Vc::uint_v::EntryType, BoolType, AssignPolicy >;
+
+
+        //! Common part of vector_helper specialisations for Vc based scalars.
+        template <typename PrimitiveType, typename RawType, size_t Size>
+        struct vc_vector_helper
         {
             //! Array needs to be like a steak - the rawest possible
             //! (Wow - I managed to WTF myself upon reading the above after a week or two)
-            typedef std::array<raw_simd_type, Size> data_type;
+            typedef std::array<RawType, Size> data_type;
 
             template <size_t... indices>
             struct proxy_generator
             {
-                typedef detail::indexed_proxy< vector<vc_float<BoolType, AssignPolicy>, sizeof...(indices)>, data_type, indices...> type;
+                typedef detail::indexed_proxy< vector<PrimitiveType, sizeof...(indices)>, data_type, indices...> type;
             };
 
             //! A factory of 1-component proxies.
             template <size_t x>
             struct proxy_generator<x>
             {
-                typedef vc_float<BoolType, AssignPolicy> type;
+                typedef PrimitiveType type;
             };
 
             typedef detail::vector_base< Size, proxy_generator, data_type > base_type;
         };
 
+        //! Specialise vector_helper so that it knows what to do.
+        template <typename BoolType, typename AssignPolicy, size_t Size>
+        struct vector_helper<vc_float<BoolType, AssignPolicy>, Size> : vc_vector_helper<vc_float<BoolType, AssignPolicy>, raw_simd_type, Size>
+        {};
+
+        template <typename BoolType, typename AssignPolicy, size_t Size>
+        struct vector_helper<vc_int<BoolType, AssignPolicy>, Size> : vc_vector_helper<vc_int<BoolType, AssignPolicy>, raw_simd_int_type, Size>
+        {};
+
+        template <typename BoolType, typename AssignPolicy, size_t Size>
+        struct vector_helper<vc_uint<BoolType, AssignPolicy>, Size> : vc_vector_helper<vc_uint<BoolType, AssignPolicy>, raw_simd_uint_type, Size>
+        {};
+
     }
 
     namespace detail
@@ -59,6 +88,151 @@ namespace swizzle
         {
             typedef ::swizzle::glsl::vector<::swizzle::glsl::vc_float<BoolType, AssignPolicy>, 1> type;
         };
+
+        template <typename BoolType, typename AssignPolicy>
+        struct get_vector_type_impl< ::swizzle::glsl::vc_int<BoolType, AssignPolicy> >
+        {
+            typedef ::swizzle::glsl::vector<::swizzle::glsl::vc_int<BoolType, AssignPolicy>, 1> type;
+        };
+
+        template <typename BoolType, typename AssignPolicy>
+        struct get_vector_type_impl< ::swizzle::glsl::vc_uint<BoolType, AssignPolicy> >
+        {
+            typedef ::swizzle::glsl::vector<::swizzle::glsl::vc_uint<BoolType, AssignPolicy>, 1> type;
+        };
+
+        //! vc_float's integer counterparts.
+        template <typename BoolType, typename AssignPolicy>
+        struct get_int_scalar_type< ::swizzle::glsl::vc_float<BoolType, AssignPolicy> >
+        {
+            typedef ::swizzle::glsl::vc_int<> type;
+        };
+
+        template <typename BoolType, typename AssignPolicy>
+        struct get_uint_scalar_type< ::swizzle::glsl::vc_float<BoolType, AssignPolicy> >
+        {
+            typedef ::swizzle::glsl::vc_uint<> type;
+        };
+
+        template <typename BoolType, typename AssignPolicy>
+        struct get_float_scalar_type< ::swizzle::glsl::vc_uint<BoolType, AssignPolicy> >
+        {
+            typedef ::swizzle::glsl::vc_float<> type;
+        };
+
+        template <typename BoolType, typename AssignPolicy>
+        struct batch_traits< ::swizzle::glsl::vc_float<BoolType, AssignPolicy> >
+        {
+            typedef ::swizzle::glsl::vc_float<BoolType, AssignPolicy> float_type;
+
+            static const size_t size = ::Vc::float_v::Size;
+            static const size_t alignment = ::Vc::VectorAlignment;
+
+            static float_type load(const float* p)
+            {
+                return ::Vc::float_v(p, ::Vc::Unaligned);
+            }
+            static void store(const float_type& v, float* p)
+            {
+                static_cast< ::Vc::float_v>(v).store(p, ::Vc::Unaligned);
+            }
+            static void load_interleaved(const float* p, float_type (&v)[3])
+            {
+                ::Vc::float_v a, b, c;
+                (a, b, c) = wrapper<3>(p)[indices()];
+                v[0] = a; v[1] = b; v[2] = c;
+            }
+            static void load_interleaved(const float* p, float_type (&v)[4])
+            {
+                ::Vc::float_v a, b, c, d;
+                (a, b, c, d) = wrapper<4>(p)[indices()];
+                v[0] = a; v[1] = b; v[2] = c; v[3] = d;
+            }
+            static void store_interleaved(const float_type (&v)[3], float* p)
+            {
+                const ::Vc::float_v a(static_cast< ::Vc::float_v>(v[0])), b(static_cast< ::Vc::float_v>(v[1])), c(static_cast< ::Vc::float_v>(v[2]));
+                wrapper<3>(p)[indices()] = (a, b, c);
+            }
+            static void store_interleaved(const float_type (&v)[4], float* p)
+            {
+                const ::Vc::float_v a(static_cast< ::Vc::float_v>(v[0])), b(static_cast< ::Vc::float_v>(v[1])), c(static_cast< ::Vc::float_v>(v[2])), d(static_cast< ::Vc::float_v>(v[3]));
+                wrapper<4>(p)[indices()] = (a, b, c, d);
+            }
+            static void stream(const float_type& v, float* p)
+            {
+                static_cast< ::Vc::float_v>(v).store(p, ::Vc::Streaming);
+            }
+            static void stream_fence()
+            {
+#ifndef VC_IMPL_Scalar
+                _mm_sfence();
+#endif
+            }
+            static ::swizzle::glsl::vc_uint<> load(const std::uint32_t* p)
+            {
+                return ::Vc::uint_v(p, ::Vc::Unaligned);
+            }
+            static void store(const ::swizzle::glsl::vc_uint<>& v, std::uint32_t* p)
+            {
+                static_cast< ::Vc::uint_v>(v).store(p, ::Vc::Unaligned);
+            }
+            //! AVX2 has a gather instruction; Vc's gather loads lane by lane.
+            static ::swizzle::glsl::vc_uint<> gather(const std::uint32_t* p, const ::swizzle::glsl::vc_uint<>& index)
+            {
+                const ::Vc::uint_v i = static_cast< ::Vc::uint_v>(index);
+#if defined(__AVX2__) && defined(VC_IMPL_AVX)
+                return ::Vc::uint_v(_mm256_i32gather_epi32(reinterpret_cast<const int*>(p), i.data(), 4));
+#elif defined(__AVX2__) && defined(VC_IMPL_SSE)
+                return ::Vc::uint_v(_mm_i32gather_epi32(reinterpret_cast<const int*>(p), i.data(), 4));
+#else
+                return ::Vc::uint_v(p, i);
+#endif
+            }
+            static float_type gather(const float* p, const ::swizzle::glsl::vc_uint<>& index)
+            {
+                const ::Vc::uint_v i = static_cast< ::Vc::uint_v>(index);
+#if defined(__AVX2__) && defined(VC_IMPL_AVX)
+                return ::Vc::float_v(_mm256_i32gather_ps(p, i.data(), 4));
+#elif defined(__AVX2__) && defined(VC_IMPL_SSE)
+                return ::Vc::float_v(_mm_i32gather_ps(p, i.data(), 4));
+#else
+                return ::Vc::float_v(p, i);
+#endif
+            }
+
+        private:
+            template <size_t N>
+            struct element
+            {
+                float data[N];
+            };
+
+            template <size_t N>
+            static ::Vc::InterleavedMemoryWrapper<const element<N>, ::Vc::float_v> wrapper(const float* p)
+            {
+                return ::Vc::InterleavedMemoryWrapper<const element<N>, ::Vc::float_v>(reinterpret_cast<const element<N>*>(p));
+            }
+
+            template <size_t N>
+            static ::Vc::InterleavedMemoryWrapper<element<N>, ::Vc::float_v> wrapper(float* p)
+            {
+                return ::Vc::InterleavedMemoryWrapper<element<N>, ::Vc::float_v>(reinterpret_cast<element<N>*>(p));
+            }
+
+            static ::Vc::float_v::IndexType indices()
+            {
+                return ::Vc::float_v::IndexType::IndexesFromZero();
+            }
+        };
+
+        //! Vc's float and int vectors are not convertible, but functions like ldexp & frexp
+        //! mix them; make sure the float one is chosen.
+        template <typename BoolType1, typename AssignPolicy1, size_t Size1, typename BoolType2, typename AssignPolicy2, size_t Size2>
+        struct common_vector_type< ::swizzle::glsl::vector<::swizzle::glsl::vc_float<BoolType1, AssignPolicy1>, Size1>, ::swizzle::glsl::vector<::swizzle::glsl::vc_int<BoolType2, AssignPolicy2>, Size2> >
+        {
+            static_assert(Size1 == Size2 || Size2 == 1, "Vectors must have same size or the int one has to have a size equal to 1");
+            typedef ::swizzle::glsl::vector<::swizzle::glsl::vc_float<BoolType1, AssignPolicy1>, Size1> type;
+        };
     }
 }
 
@@ -96,5 +270,262 @@ namespace Vc
         {
             return x - floor(x);
         }
+
+        template <typename T>
+        inline Vector<T> fma(const Vector<T>& a, const Vector<T>& b, const Vector<T>& c)
+        {
+            // maps to a single instruction where FMA/FMA4 is available
+            auto result = a;
+            result.fusedMultiplyAdd(b, c);
+            return result;
+        }
+
+        template <typename T>
+        inline Vector<T> roundEven(const Vector<T>& x)
+        {
+            // Vc's round uses the "round to nearest" mode, which breaks ties to even
+            return round(x);
+        }
+
+        template <typename T>
+        inline Vector<T> modf(const Vector<T>& x, Vector<T>* i)
+        {
+            *i = trunc(x);
+            return x - *i;
+        }
+
+        template <typename T>
+        inline typename Vector<T>::Mask isinf(const Vector<T>& x)
+        {
+            return abs(x) == Vector<T>(std::numeric_limits<T>::infinity());
+        }
+    
+        // packing functions
+
+        inline uint_v packUnorm4x8(const float_v& x, const float_v& y, const float_v& z, const float_v& w)
+        {
+#if defined(VC_IMPL_SSE4_1) && !defined(VC_IMPL_AVX) && !defined(VC_IMPL_Scalar)
+            // cvtps2dq rounds to nearest even; negative values are taken care of by the unsigned
+            // saturation, so only the upper bound needs clamping
+            const float_v one = float_v::One();
+            const float_v scale(255.0f);
+            __m128i xy = _mm_packus_epi32(_mm_cvtps_epi32((min(x, one) * scale).data()), _mm_cvtps_epi32((min(y, one) * scale).data()));
+            __m128i zw = _mm_packus_epi32(_mm_cvtps_epi32((min(z, one) * scale).data()), _mm_cvtps_epi32((min(w, one) * scale).data()));
+            // bytes are grouped by channel now (x0 x1 x2 x3 y0 ...), interleave them
+            __m128i bytes = _mm_packus_epi16(xy, zw);
+            return uint_v(_mm_shuffle_epi8(bytes, _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15)));
+#else
+            auto c = [](const float_v& v) -> uint_v { return static_cast<uint_v>(round(min(max(v, float_v::Zero()), float_v::One()) * 255.0f)); };
+            return c(x) | (c(y) << 8) | (c(z) << 16) | (c(w) << 24);
+#endif
+        }
+
+        inline uint_v packSnorm4x8(const float_v& x, const float_v& y, const float_v& z, const float_v& w)
+        {
+            auto c = [](const float_v& v) -> uint_v { return static_cast<uint_v>(static_cast<int_v>(round(min(max(v, float_v(-1.0f)), float_v::One()) * 127.0f))) & 0xffu; };
+            return c(x) | (c(y) << 8) | (c(z) << 16) | (c(w) << 24);
+        }
+
+        inline uint_v packUnorm2x16(const float_v& x, const float_v& y)
+        {
+            auto c = [](const float_v& v) -> uint_v { return static_cast<uint_v>(round(min(max(v, float_v::Zero()), float_v::One()) * 65535.0f)); };
+            return c(x) | (c(y) << 16);
+        }
+
+        inline uint_v packSnorm2x16(const float_v& x, const float_v& y)
+        {
+            auto c = [](const float_v& v) -> uint_v { return static_cast<uint_v>(static_cast<int_v>(round(min(max(v, float_v(-1.0f)), float_v::One()) * 32767.0f))) & 0xffffu; };
+            return c(x) | (c(y) << 16);
+        }
+
+        inline void unpackUnorm4x8(const uint_v& p, float_v* x, float_v* y, float_v* z, float_v* w)
+        {
+            *x = static_cast<float_v>(p & 0xffu) / 255.0f;
+            *y = static_cast<float_v>((p >> 8) & 0xffu) / 255.0f;
+            *z = static_cast<float_v>((p >> 16) & 0xffu) / 255.0f;
+            *w = static_cast<float_v>(p >> 24) / 255.0f;
+        }
+
+        inline void unpackSnorm4x8(const uint_v& p, float_v* x, float_v* y, float_v* z, float_v* w)
+        {
+            // arithmetic shift does the sign extension
+            auto c = [](const uint_v& v) -> float_v { return max(static_cast<float_v>(static_cast<int_v>(v) >> 24) / 127.0f, float_v(-1.0f)); };
+            *x = c(p << 24);
+            *y = c(p << 16);
+            *z = c(p << 8);
+            *w = c(p);
+        }
+
+        inline void unpackUnorm2x16(const uint_v& p, float_v* x, float_v* y)
+        {
+            *x = static_cast<float_v>(p & 0xffffu) / 65535.0f;
+            *y = static_cast<float_v>(p >> 16) / 65535.0f;
+        }
+
+        inline void unpackSnorm2x16(const uint_v& p, float_v* x, float_v* y)
+        {
+            auto c = [](const uint_v& v) -> float_v { return max(static_cast<float_v>(static_cast<int_v>(v) >> 16) / 32767.0f, float_v(-1.0f)); };
+            *x = c(p << 16);
+            *y = c(p);
+        }
+
+        //! Branch-free version of std::packHalf2x16's conversion; all the cases are computed and then blended.
+        inline uint_v packHalf2x16(const float_v& x, const float_v& y)
+        {
+            auto c = [](const float_v& v) -> uint_v
+            {
+                const uint_v f32infty(255u << 23);
+                const uint_v f16max((127u + 16u) << 23);
+                const uint_v denormMagicBits(((127u - 15u) + (23u - 10u) + 1u) << 23);
+
+                uint_v u = v.reinterpretCast<uint_v>();
+                uint_v sign = u & 0x80000000u;
+                u ^= sign;
+
+                uint_v mantOdd = (u >> 13) & 1u;
+                uint_v result = (u + (static_cast<unsigned>(15 - 127) << 23) + 0xfffu + mantOdd) >> 13;
+
+                uint_v subnormal = (u.reinterpretCast<float_v>() + denormMagicBits.reinterpretCast<float_v>()).reinterpretCast<uint_v>() - denormMagicBits;
+                result(u < uint_v(113u << 23)) = subnormal;
+
+                uint_v special(0x7c00u);
+                special(u > f32infty) = uint_v(0x7e00u);
+                result(u >= f16max) = special;
+
+                return result | (sign >> 16);
+            };
+            return c(x) | (c(y) << 16);
+        }
+
+        inline void unpackHalf2x16(const uint_v& p, float_v* x, float_v* y)
+        {
+            auto c = [](const uint_v& h) -> float_v
+            {
+                const uint_v shiftedExp(0x7c00u << 13);
+                const float_v magic = uint_v(113u << 23).reinterpretCast<float_v>();
+
+                uint_v o = (h & 0x7fffu) << 13;
+                uint_v exp = o & shiftedExp;
+                o += uint_v((127u - 15u) << 23);
+
+                uint_v infOrNan = o + uint_v((128u - 16u) << 23);
+                uint_v subnormal = ((o + uint_v(1u << 23)).reinterpretCast<float_v>() - magic).reinterpretCast<uint_v>();
+                o(exp == shiftedExp) = infOrNan;
+                o(exp == uint_v::Zero()) = subnormal;
+
+                o |= (h & 0x8000u) << 16;
+                return o.reinterpretCast<float_v>();
+            };
+            *x = c(p & 0xffffu);
+            *y = c(p >> 16);
+        }
+
+        //! Applies a scalar function to each lane and packs the results back. This is a slow path,
+        //! but works with anything callable with scalars.
+        template <typename Func, typename T, typename... Args>
+        inline Vector<T> lane_map(Func func, const Vector<T>& x, const Args&... args)
+        {
+            Vector<T> result;
+            for (size_t i = 0; i < Vector<T>::Size; ++i)
+            {
+                result[i] = func(x[i], args[i]...);
+            }
+            return result;
+        }
+
+        // Fallbacks for functions primitive_wrapper forwards to. They are less specialised than
+        // Vc's (and the above) Vector<T> overloads, so they only kick in if there isn't a SIMD
+        // version. Define CXXSWIZZLE_LANE_MAP_REPORT to get a deprecation warning for each
+        // function that got instantiated this way, i.e. a list of functions worth vectorising.
+
+#ifdef CXXSWIZZLE_LANE_MAP_REPORT
+#ifdef _MSC_VER
+#define CXXSWIZZLE_DETAIL_SLOW_PATH_MARKER(name) \
+        template <typename V> __declspec(deprecated(#name " has no SIMD implementation, using lane_map")) inline void lane_map_slow_path_##name() {}
+#else
+#define CXXSWIZZLE_DETAIL_SLOW_PATH_MARKER(name) \
+        template <typename V> __attribute__((deprecated(#name " has no SIMD implementation, using lane_map"))) inline void lane_map_slow_path_##name() {}
+#endif
+// dependent call, so that the warning is issued on instantiation only
+#define CXXSWIZZLE_DETAIL_SLOW_PATH_REPORT(name) lane_map_slow_path_##name<V>()
+#else
+#define CXXSWIZZLE_DETAIL_SLOW_PATH_MARKER(name)
+#define CXXSWIZZLE_DETAIL_SLOW_PATH_REPORT(name)
+#endif
+
+#define CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(name) \
+        CXXSWIZZLE_DETAIL_SLOW_PATH_MARKER(name) \
+        template <typename V> \
+        inline typename std::enable_if<std::is_same<V, float_v>::value, V>::type name(const V& x) \
+        { \
+            CXXSWIZZLE_DETAIL_SLOW_PATH_REPORT(name); \
+            return lane_map([](float x) -> float { return ::std::name(x); }, x); \
+        }
+
+#define CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_2(name) \
+        CXXSWIZZLE_DETAIL_SLOW_PATH_MARKER(name) \
+        template <typename V> \
+        inline typename std::enable_if<std::is_same<V, float_v>::value, V>::type name(const V& x, const V& y) \
+        { \
+            CXXSWIZZLE_DETAIL_SLOW_PATH_REPORT(name); \
+            return lane_map([](float x, float y) -> float { return ::std::name(x, y); }, x, y); \
+        }
+
+#define CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_3(name) \
+        CXXSWIZZLE_DETAIL_SLOW_PATH_MARKER(name) \
+        template <typename V> \
+        inline typename std::enable_if<std::is_same<V, float_v>::value, V>::type name(const V& x, const V& y, const V& z) \
+        { \
+            CXXSWIZZLE_DETAIL_SLOW_PATH_REPORT(name); \
+            return lane_map([](float x, float y, float z) -> float { return ::std::name(x, y, z); }, x, y, z); \
+        }
+
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(sin)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(cos)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(tan)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(asin)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(acos)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(atan)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_2(atan2)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(abs)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_2(pow)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(exp)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(log)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(exp2)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(log2)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(sqrt)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(rsqrt)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(sign)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(fract)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(floor)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(ceil)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(trunc)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(round)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1(roundEven)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_3(fma)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_2(min)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_2(max)
+        CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_2(step)
+
+#undef CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_1
+#undef CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_2
+#undef CXXSWIZZLE_DETAIL_LANE_MAP_FALLBACK_3
+#undef CXXSWIZZLE_DETAIL_SLOW_PATH_MARKER
+#undef CXXSWIZZLE_DETAIL_SLOW_PATH_REPORT
     }
-}
\ No newline at end of file
+}
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! Unpacks lanes of vc_floats, calls func with each lane's scalars and packs the results back.
+        //! Use for functions without a SIMD implementation.
+        template <typename Func, typename BoolType, typename AssignPolicy, typename... Args>
+        inline vc_float<BoolType, AssignPolicy> lane_map(Func func, const vc_float<BoolType, AssignPolicy>& x, const Args&... args)
+        {
+            // ADL picks Vc's version
+            return lane_map(func, static_cast<::Vc::float_v>(x), static_cast<::Vc::float_v>(args)...);
+        }
+    }
+}
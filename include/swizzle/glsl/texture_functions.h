@@ -10,10 +10,15 @@ namespace swizzle
         {
             //! Deriving from this struct will make sure all texture* calls are going to be ADL resolved, without
             //! "using" this namespace.
+            //!
+            //! The functions below only forward to the sampler, which works on whole batches of lanes at once
+            //! (see sampler2D). A sampler exposes float_type, int_type, tex_coord_type, tex_offset_type and
+            //! texel_coord_type typedefs and whichever of sample, sampleLod, sampleGrad, sampleOffset,
+            //! sampleProj, fetchTexel, size, gather and gatherOffset it supports; the rest simply do not resolve.
             struct tag {};
 
             template <class Sampler>
-            auto texture(Sampler& sampler, typename Sampler::tex_coord_type coord) -> decltype ( sampler.sample(coord) )
+            auto texture(const Sampler& sampler, typename Sampler::tex_coord_type coord) -> decltype ( sampler.sample(coord) )
             {
                 return sampler.sample(coord);
             }
@@ -24,16 +29,63 @@ namespace swizzle
                 return sampler.sample(coord, bias);
             }
 
+            //! Explicit level of detail; fractional ones blend two levels if the sampler filters between them.
+            template <class Sampler>
+            auto textureLod(const Sampler& sampler, typename Sampler::tex_coord_type coord, const typename Sampler::float_type& lod) -> decltype( sampler.sampleLod(coord, lod) )
+            {
+                return sampler.sampleLod(coord, lod);
+            }
+
+            //! Level of detail derived from explicit coordinate derivatives.
+            template <class Sampler>
+            auto textureGrad(const Sampler& sampler, typename Sampler::tex_coord_type coord, typename Sampler::tex_coord_type dPdx, typename Sampler::tex_coord_type dPdy) -> decltype( sampler.sampleGrad(coord, dPdx, dPdy) )
+            {
+                return sampler.sampleGrad(coord, dPdx, dPdy);
+            }
+
             template <class Sampler>
             auto textureOffset(const Sampler& sampler, typename Sampler::tex_coord_type coord, typename Sampler::tex_offset_type offset) -> decltype( sampler.sampleOffset(coord, offset) )
             {
-                return sampler.sample(coord, offset);
+                return sampler.sampleOffset(coord, offset);
             }
 
             template <class Sampler>
             auto textureOffset(const Sampler& sampler, typename Sampler::tex_coord_type coord, typename Sampler::tex_offset_type offset, float bias) -> decltype( sampler.sampleOffset(coord, offset, bias) )
             {
-                return sampler.sample(coord, offset, bias);
+                return sampler.sampleOffset(coord, offset, bias);
+            }
+
+            //! coord is divided by its last component first.
+            template <class Sampler, class Coord>
+            auto textureProj(const Sampler& sampler, const Coord& coord) -> decltype( sampler.sampleProj(coord) )
+            {
+                return sampler.sampleProj(coord);
+            }
+
+            //! A single texel of the given level: no filtering, no wrapping.
+            template <class Sampler>
+            auto texelFetch(const Sampler& sampler, typename Sampler::texel_coord_type coord, const typename Sampler::int_type& lod) -> decltype( sampler.fetchTexel(coord, lod) )
+            {
+                return sampler.fetchTexel(coord, lod);
+            }
+
+            template <class Sampler>
+            auto textureSize(const Sampler& sampler, const typename Sampler::int_type& lod) -> decltype( sampler.size(lod) )
+            {
+                return sampler.size(lod);
+            }
+
+            //! Component comp of the four texels a bilinear lookup would blend.
+            template <class Sampler>
+            auto textureGather(const Sampler& sampler, typename Sampler::tex_coord_type coord, int comp = 0) -> decltype( sampler.gather(coord, comp) )
+            {
+                return sampler.gather(coord, comp);
+            }
+
+            template <class Sampler>
+            auto textureGatherOffset(const Sampler& sampler, typename Sampler::tex_coord_type coord, typename Sampler::tex_offset_type offset, int comp = 0) -> decltype( sampler.gatherOffset(coord, offset, comp) )
+            {
+                return sampler.gatherOffset(coord, offset, comp);
             }
         }
     }
@@ -0,0 +1,1144 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <swizzle/detail/aligned_allocator.h>
+#include <swizzle/detail/block_compression.h>
+#include <swizzle/detail/file_replace.h>
+#include <swizzle/detail/paged_memory.h>
+#include <swizzle/detail/vector_traits.h>
+#include <swizzle/glsl/scalar_support.h>
+#include <swizzle/glsl/vector.h>
+#include <swizzle/glsl/texture_functions.h>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! Sampler state shared by all samplers: wrapping and filtering, plus the enums they are set with.
+        class sampler_base : public texture_functions::tag
+        {
+        public:
+            enum wrap_mode
+            {
+                wrap_clamp,
+                wrap_repeat,
+                wrap_mirror_repeat
+            };
+
+            //! Filtering within a level.
+            enum filter_mode
+            {
+                filter_nearest,
+                filter_linear
+            };
+
+            //! Filtering between levels; mipmap_linear with filter_linear is trilinear filtering.
+            enum mipmap_mode
+            {
+                mipmap_none,
+                mipmap_nearest,
+                mipmap_linear
+            };
+
+            sampler_base(wrap_mode wrap, filter_mode filter)
+                : m_wrap(wrap)
+                , m_filter(filter)
+            {}
+
+            wrap_mode wrap() const
+            {
+                return m_wrap;
+            }
+
+            void wrap(wrap_mode value)
+            {
+                m_wrap = value;
+            }
+
+            filter_mode filter() const
+            {
+                return m_filter;
+            }
+
+            void filter(filter_mode value)
+            {
+                m_filter = value;
+            }
+
+        protected:
+            //! Maps an integral texel coordinate into [0, size). Done with floats, as SIMD integer division
+            //! is not a thing; exact for coordinates below 2^24. The final integer clamp keeps NaNs and
+            //! huge coordinates from reading out of bounds.
+            template <class FloatType, class UintType>
+            UintType wrap_coord(const FloatType& x, const FloatType& size, const UintType& max_index) const
+            {
+                using namespace std;
+
+                FloatType result;
+                switch (m_wrap)
+                {
+                case wrap_repeat:
+                    result = x - floor(x / size) * size;
+                    break;
+                case wrap_mirror_repeat:
+                    {
+                        FloatType period = size * 2.0f;
+                        FloatType m = x - floor(x / period) * period;
+                        result = min(m, (period - 1.0f) - m);
+                    }
+                    break;
+                case wrap_clamp:
+                default:
+                    result = max(x, FloatType(0.0f));
+                    break;
+                }
+                return min(UintType(result), max_index);
+            }
+
+        private:
+            wrap_mode m_wrap;
+            filter_mode m_filter;
+        };
+
+        //! A 2D texture with a sampler state, usable with texture_functions. Texels are decoded once, when
+        //! assigned, to one of texel_formats, and a box filtered mip chain is built; sampling is a gather
+        //! per texel word plus at most one conversion, and lanes never leave FloatType, so SIMD scalar
+        //! types (vc_float, requires detail::batch_traits specialisation) sample a whole batch of
+        //! coordinates, each at its own LOD.
+        //! Coordinates follow OpenGL: (0, 0) is the first texel in memory, i.e. rows go bottom-up.
+        //! Texels can be stored in 4x4 tiles, each one a 64 byte cache line, so that footprints of lanes
+        //! walking vertically (rotated or minified) touch fewer lines than with row-major storage. That is
+        //! the default for SIMD types; scalar samplers, with one footprint at a time, are better off
+        //! row-major (see benchmark/texture_layout.cpp).
+        //! Block compressed textures (assign_compressed) stay compressed; 4x4 blocks are decoded on demand
+        //! into a per-thread cache and addressed exactly like 4x4 tiles.
+        //! Textures can be saved in their final form and later mapped (assign_mapped) instead of decoded,
+        //! so that only pages actually sampled are read; see texture_store.
+        template <class FloatType>
+        class sampler2D : public sampler_base
+        {
+        public:
+            typedef FloatType float_type;
+            typedef typename detail::get_int_scalar_type<FloatType>::type int_type;
+            typedef typename detail::get_uint_scalar_type<FloatType>::type uint_type;
+            typedef vector<FloatType, 2> vec2_type;
+            typedef vector<FloatType, 3> vec3_type;
+            typedef vector<FloatType, 4> vec4_type;
+            typedef vector<int_type, 2> ivec2_type;
+            typedef const vec2_type& tex_coord_type;
+            typedef const ivec2_type& tex_offset_type;
+            typedef const ivec2_type& texel_coord_type;
+
+            //! How texels are laid out in memory; conversion happens once, on assign.
+            enum texel_layout
+            {
+                layout_linear,
+                layout_tiled
+            };
+
+            //! Internal texel formats; planar ones keep each 32 bit word of a texel in a separate array.
+            //! Conversion happens once, on assign, except for BCn ones, which can only be assigned already
+            //! compressed and are decoded when sampled.
+            enum texel_format
+            {
+                //! 4 bytes, packUnorm4x8 layout; a gather and an unpack
+                format_rgba8,
+                //! 8 bytes, packHalf2x16 of RG and of BA; two gathers and unpacks
+                format_rgba16f,
+                format_rgba16f_planar,
+                //! 16 bytes; four gathers, no conversion
+                format_rgba32f,
+                format_rgba32f_planar,
+                //! BCn blocks of 4x4 texels: RGB + 1 bit alpha in 8 bytes
+                format_bc1,
+                //! RGBA in 16 bytes
+                format_bc3,
+                //! R in 8 bytes, sampled as (r, 0, 0, 1)
+                format_bc4,
+                //! RG in 16 bytes, sampled as (r, g, 0, 1)
+                format_bc5,
+                //! RGBA in 16 bytes, higher quality than BC3
+                format_bc7
+            };
+
+            static const texel_layout default_layout = detail::batch_traits<FloatType>::size > 1 ? layout_tiled : layout_linear;
+
+            //! Tiles are tile_size x tile_size texels, row-major inside.
+            static const unsigned tile_size = 4;
+            static_assert(tile_size == 4, "row_index and column_index need updating");
+
+        // CONSTRUCTION
+        public:
+
+            //! An empty texture; samples are (0, 0, 0, 1), like an incomplete texture in OpenGL.
+            sampler2D(wrap_mode wrap = wrap_repeat, filter_mode filter = filter_linear, mipmap_mode mipmap = mipmap_linear)
+                : sampler_base(wrap, filter)
+                , m_mipmap(mipmap)
+                , m_max_anisotropy(1.0f)
+                , m_layout(default_layout)
+                , m_format(format_rgba8)
+                , m_plane_size(0)
+                , m_cache_id(0)
+                , m_data_offset(0)
+            {}
+
+            sampler2D(size_t width, size_t height, const std::uint32_t* texels, wrap_mode wrap = wrap_repeat, filter_mode filter = filter_linear, mipmap_mode mipmap = mipmap_linear, texel_layout layout = default_layout, texel_format format = format_rgba8)
+                : sampler_base(wrap, filter)
+                , m_mipmap(mipmap)
+                , m_max_anisotropy(1.0f)
+            {
+                assign(width, height, texels, layout, format);
+            }
+
+            sampler2D(size_t width, size_t height, const float* texels, wrap_mode wrap = wrap_repeat, filter_mode filter = filter_linear, mipmap_mode mipmap = mipmap_linear, texel_layout layout = default_layout, texel_format format = format_rgba32f)
+                : sampler_base(wrap, filter)
+                , m_mipmap(mipmap)
+                , m_max_anisotropy(1.0f)
+            {
+                assign(width, height, texels, layout, format);
+            }
+
+            //! Decodes width * height row-major RGBA8 texels, R in the lowest byte (packUnorm4x8 layout),
+            //! generates the mip chain down to 1x1 and stores all levels in the requested layout and format.
+            void assign(size_t width, size_t height, const std::uint32_t* texels, texel_layout layout = default_layout, texel_format format = format_rgba8)
+            {
+                std::vector<float> rgba(width * height * 4);
+                for (size_t i = 0; i < width * height; ++i)
+                {
+                    std::unpackUnorm4x8(texels[i], &rgba[i * 4], &rgba[i * 4 + 1], &rgba[i * 4 + 2], &rgba[i * 4 + 3]);
+                }
+                build(width, height, rgba, layout, format);
+            }
+
+            //! As above, but texels are 4 floats each; useful for HDR data.
+            void assign(size_t width, size_t height, const float* texels, texel_layout layout = default_layout, texel_format format = format_rgba32f)
+            {
+                std::vector<float> rgba(texels, texels + width * height * 4);
+                build(width, height, rgba, layout, format);
+            }
+
+            //! As above, taking over the texels rather than copying them, e.g. ones just decoded.
+            void assign(size_t width, size_t height, std::vector<float>&& rgba, texel_layout layout = default_layout, texel_format format = format_rgba32f)
+            {
+                rgba.resize(width * height * 4);
+                build(width, height, rgba, layout, format);
+            }
+
+            //! Copies levels of BCn blocks, as stored in DDS files: row-major blocks of the base level, then
+            //! of each following one, halving the size down to levels, at most down to 1x1. There is no
+            //! encoder, so format needs to be one of the BCn ones and levels are not generated.
+            void assign_compressed(size_t width, size_t height, texel_format format, const void* blocks, size_t levels = 1)
+            {
+                m_level_offsets.clear();
+                m_level_widths.clear();
+                m_level_heights.clear();
+                m_level_pitches.clear();
+                m_layout = layout_tiled;
+                m_format = format;
+                m_float_texels.clear();
+                m_mapped.reset();
+                m_data_offset = 0;
+
+                size_t block_count = 0;
+                for (size_t w = width, h = height; width && height && m_level_offsets.size() < levels; w = std::max<size_t>(w / 2, 1), h = std::max<size_t>(h / 2, 1))
+                {
+                    const size_t blocks_x = (w + tile_size - 1) / tile_size;
+                    const size_t blocks_y = (h + tile_size - 1) / tile_size;
+                    m_level_offsets.push_back(static_cast<std::uint32_t>(block_count * tile_size * tile_size));
+                    m_level_widths.push_back(static_cast<std::uint32_t>(w));
+                    m_level_heights.push_back(static_cast<std::uint32_t>(h));
+                    m_level_pitches.push_back(static_cast<std::uint32_t>(blocks_x * tile_size * tile_size));
+                    block_count += blocks_x * blocks_y;
+                    if (w == 1 && h == 1)
+                    {
+                        break;
+                    }
+                }
+                if (m_level_offsets.empty())
+                {
+                    m_level_offsets.assign(1, 0);
+                    m_level_widths.assign(1, 0);
+                    m_level_heights.assign(1, 0);
+                    m_level_pitches.assign(1, 0);
+                }
+
+                const size_t bytes = block_count * block_bytes(format);
+                m_texels.resize((bytes + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t));
+                if (bytes)
+                {
+                    std::memcpy(m_texels.data(), blocks, bytes);
+                }
+                m_plane_size = block_count * tile_size * tile_size;
+                m_cache_id = detail::decoded_block_cache::next_id();
+            }
+
+            //! Uses a file written by save, usually opened with texture_store, without copying it: texels
+            //! are read straight from it as they are sampled. Returns false, leaving the texture empty, if
+            //! it is not such a file.
+            bool assign_mapped(std::shared_ptr<const detail::paged_memory> file)
+            {
+                m_mapped.reset();
+                m_data_offset = 0;
+                m_plane_size = 0;
+                m_texels.clear();
+                m_float_texels.clear();
+                m_level_offsets.assign(1, 0);
+                m_level_widths.assign(1, 0);
+                m_level_heights.assign(1, 0);
+                m_level_pitches.assign(1, 0);
+                m_format = format_rgba8;
+                m_cache_id = 0;
+
+                if (!file || file->size() < sizeof(file_header))
+                {
+                    return false;
+                }
+
+                file->touch(0);
+                file_header header;
+                std::memcpy(&header, file->data(), sizeof(header));
+                const size_t tables = sizeof(header) + header.levels * 4 * sizeof(std::uint32_t);
+                if (header.magic != file_magic || header.version != file_version || header.format > format_bc7 || header.layout > layout_tiled ||
+                    header.levels == 0 || header.levels > max_file_levels || header.plane_size == 0 || tables > file->size() || tables > header.data_offset ||
+                    header.data_offset % 64 || header.data_offset > file->size() ||
+                    word_count(static_cast<texel_format>(header.format), header.plane_size) > (file->size() - header.data_offset) / sizeof(std::uint32_t))
+                {
+                    return false;
+                }
+
+                // the header and level tables are well within the first page
+                std::vector<std::uint32_t> levels(header.levels * 4);
+                std::memcpy(levels.data(), file->data() + sizeof(header), levels.size() * sizeof(std::uint32_t));
+                for (size_t i = 0; i < header.levels; ++i)
+                {
+                    // the last texel of each level needs to be within the file
+                    const std::uint64_t offset = levels[i * 4], width = levels[i * 4 + 1], height = levels[i * 4 + 2], pitch = levels[i * 4 + 3];
+                    const std::uint64_t last = header.layout == layout_tiled ?
+                        offset + ((height - 1) >> 2) * pitch + ((((width - 1) >> 2) << 4) | 15) :
+                        offset + (height - 1) * pitch + width - 1;
+                    if (!width || !height || last >= header.plane_size)
+                    {
+                        return false;
+                    }
+                }
+
+                m_level_offsets.resize(header.levels);
+                m_level_widths.resize(header.levels);
+                m_level_heights.resize(header.levels);
+                m_level_pitches.resize(header.levels);
+                for (size_t i = 0; i < header.levels; ++i)
+                {
+                    m_level_offsets[i] = levels[i * 4];
+                    m_level_widths[i] = levels[i * 4 + 1];
+                    m_level_heights[i] = levels[i * 4 + 2];
+                    m_level_pitches[i] = levels[i * 4 + 3];
+                }
+                m_format = static_cast<texel_format>(header.format);
+                m_layout = static_cast<texel_layout>(header.layout);
+                m_plane_size = header.plane_size;
+                m_data_offset = header.data_offset;
+                m_mapped = std::move(file);
+                m_cache_id = is_compressed(m_format) ? detail::decoded_block_cache::next_id() : 0;
+                return true;
+            }
+
+            //! Writes levels, layout, format and texels, exactly as they are held, for assign_mapped. Native
+            //! byte order; the texels start at a 4kB boundary. The file is replaced, not rewritten, so other
+            //! processes may keep it mapped meanwhile. Returns false for empty textures and if the file could
+            //! not be written.
+            bool save(const char* path) const
+            {
+                if (empty())
+                {
+                    return false;
+                }
+
+                file_header header;
+                header.magic = file_magic;
+                header.version = file_version;
+                header.format = m_format;
+                header.layout = m_layout;
+                header.levels = static_cast<std::uint32_t>(m_level_offsets.size());
+                header.plane_size = static_cast<std::uint32_t>(m_plane_size);
+                const size_t tables = sizeof(header) + header.levels * 4 * sizeof(std::uint32_t);
+                header.data_offset = static_cast<std::uint32_t>((tables + 4095) & ~static_cast<size_t>(4095));
+                header.reserved = 0;
+
+                std::vector<std::uint32_t> levels;
+                for (size_t i = 0; i < m_level_offsets.size(); ++i)
+                {
+                    const std::uint32_t level[] = { m_level_offsets[i], m_level_widths[i], m_level_heights[i], m_level_pitches[i] };
+                    levels.insert(levels.end(), level, level + 4);
+                }
+                const std::vector<char> padding(header.data_offset - tables);
+                const char* texels = is_float(m_format) ? reinterpret_cast<const char*>(texel_floats()) : reinterpret_cast<const char*>(texel_words());
+
+                const size_t texel_bytes = word_count(m_format, m_plane_size) * sizeof(std::uint32_t);
+                return detail::replace_file(path, [&](std::ostream& out)
+                {
+                    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                    out.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(std::uint32_t));
+                    out.write(padding.data(), padding.size());
+                    out.write(texels, texel_bytes);
+                });
+            }
+
+        // STATE
+        public:
+
+            size_t width() const
+            {
+                return m_level_widths.empty() ? 0 : m_level_widths[0];
+            }
+
+            size_t height() const
+            {
+                return m_level_heights.empty() ? 0 : m_level_heights[0];
+            }
+
+            //! Number of mip levels, including the base one.
+            size_t levels() const
+            {
+                return empty() ? 0 : m_level_offsets.size();
+            }
+
+            texel_layout layout() const
+            {
+                return m_layout;
+            }
+
+            texel_format format() const
+            {
+                return m_format;
+            }
+
+            mipmap_mode mipmap() const
+            {
+                return m_mipmap;
+            }
+
+            void mipmap(mipmap_mode value)
+            {
+                m_mipmap = value;
+            }
+
+            float max_anisotropy() const
+            {
+                return m_max_anisotropy;
+            }
+
+            //! Most probes sampleGrad takes along a footprint longer than wide; 1 (the default) turns
+            //! anisotropic filtering off. Fractions are rounded down.
+            void max_anisotropy(float value)
+            {
+                m_max_anisotropy = value > 1.0f ? value : 1.0f;
+            }
+
+        // SAMPLING
+        public:
+
+            //! There are no implicit derivatives, so the base level is sampled (or the bias one).
+            vec4_type sample(const vec2_type& coord) const
+            {
+                return sample_lod(coord, nullptr);
+            }
+
+            vec4_type sample(const vec2_type& coord, const float_type& bias) const
+            {
+                return sample_lod(coord, &bias);
+            }
+
+            vec4_type sampleLod(const vec2_type& coord, const float_type& lod) const
+            {
+                return sample_lod(coord, &lod);
+            }
+
+            //! Offset is in texels, added before wrapping.
+            vec4_type sampleOffset(const vec2_type& coord, const ivec2_type& offset) const
+            {
+                return sample_lod(coord, nullptr, &offset);
+            }
+
+            vec4_type sampleOffset(const vec2_type& coord, const ivec2_type& offset, const float_type& bias) const
+            {
+                return sample_lod(coord, &bias, &offset);
+            }
+
+            //! coord.xy / coord.z
+            vec4_type sampleProj(const vec3_type& coord) const
+            {
+                return sample(vec2_type(coord.x / coord.z, coord.y / coord.z));
+            }
+
+            //! coord.xy / coord.w
+            vec4_type sampleProj(const vec4_type& coord) const
+            {
+                return sample(vec2_type(coord.x / coord.w, coord.y / coord.w));
+            }
+
+            //! LOD is log2 of the longer of the two texel space gradients, as in the OpenGL spec. With
+            //! max_anisotropy() above 1 the footprint is covered by up to that many probes along the longer
+            //! gradient instead, each with a LOD that much finer (EXT_texture_filter_anisotropic).
+            vec4_type sampleGrad(const vec2_type& coord, const vec2_type& dPdx, const vec2_type& dPdy) const
+            {
+                using namespace std;
+
+                const vec2_type size(float_type(static_cast<float>(width())), float_type(static_cast<float>(height())));
+                vec2_type dx = dPdx * size;
+                vec2_type dy = dPdy * size;
+                float_type px2 = vec2_type::call_dot(dx, dx);
+                float_type py2 = vec2_type::call_dot(dy, dy);
+
+                if (m_max_anisotropy >= 2.0f)
+                {
+                    return sample_anisotropic(coord, dPdx, dPdy, px2, py2);
+                }
+
+                // log2(sqrt(x)) == 0.5 * log2(x); log2(0) is -inf, which clamps to the base level
+                float_type lod = log2(max(px2, py2)) * 0.5f;
+                return sample_lod(coord, &lod);
+            }
+
+            //! A single texel of a level, no filtering nor wrapping; the cheapest lookup. Out of range
+            //! coordinates are undefined in GLSL; here they are clamped.
+            vec4_type fetchTexel(const ivec2_type& coord, const int_type& lod) const
+            {
+                using namespace std;
+
+                if (empty())
+                {
+                    return vec4_type(float_type(0.0f), float_type(0.0f), float_type(0.0f), float_type(1.0f));
+                }
+
+                level_lanes lvl = level(uint_type(max(lod, int_type(0))));
+                uint_type x = min(uint_type(max(coord.x, int_type(0))), lvl.max_x);
+                uint_type y = min(uint_type(max(coord.y, int_type(0))), lvl.max_y);
+                return fetch(row_index(lvl, y) + column_index(x));
+            }
+
+            //! Dimensions of a level; lod is clamped to existing levels.
+            ivec2_type size(const int_type& lod) const
+            {
+                using namespace std;
+                typedef detail::batch_traits<FloatType> traits;
+
+                if (empty())
+                {
+                    return ivec2_type(int_type(0), int_type(0));
+                }
+
+                uint_type i = level_index(uint_type(max(lod, int_type(0))));
+                return ivec2_type(int_type(traits::gather(m_level_widths.data(), i)), int_type(traits::gather(m_level_heights.data(), i)));
+            }
+
+            //! Component comp (0 - 3) of the four texels bilinear filtering would blend, in GLSL's order:
+            //! (i0, j1), (i1, j1), (i1, j0), (i0, j0). Base level only.
+            vec4_type gather(const vec2_type& coord, int comp = 0) const
+            {
+                return gather_offset(coord, nullptr, comp);
+            }
+
+            vec4_type gatherOffset(const vec2_type& coord, const ivec2_type& offset, int comp = 0) const
+            {
+                return gather_offset(coord, &offset, comp);
+            }
+
+        private:
+            //! Start of files written by save, followed by offset, width, height and pitch of each level.
+            struct file_header
+            {
+                std::uint32_t magic;
+                std::uint32_t version;
+                std::uint32_t format;
+                std::uint32_t layout;
+                std::uint32_t levels;
+                std::uint32_t plane_size;
+                std::uint32_t data_offset;
+                std::uint32_t reserved;
+            };
+
+            //! "CXTX"
+            static const std::uint32_t file_magic = 0x58545843;
+            static const std::uint32_t file_version = 1;
+            //! Enough for 2^31 x 2^31 textures; keeps the tables within the first page.
+            static const std::uint32_t max_file_levels = 32;
+
+            //! Per-lane description of a mip level; pitch is the distance between rows (or rows of tiles).
+            struct level_lanes
+            {
+                uint_type offset;
+                uint_type pitch;
+                uint_type max_x;
+                uint_type max_y;
+                float_type width;
+                float_type height;
+            };
+
+            //! Integral texel coordinates of a bilinear footprint: (x0, y0) to (x0 + 1, y0 + 1), not wrapped yet.
+            struct footprint
+            {
+                float_type x0;
+                float_type y0;
+                float_type fx;
+                float_type fy;
+            };
+
+            //! lod == nullptr means the base level without going through level tables.
+            vec4_type sample_lod(const vec2_type& coord, const float_type* lod, const ivec2_type* offset = nullptr) const
+            {
+                using namespace std;
+
+                if (empty())
+                {
+                    return vec4_type(float_type(0.0f), float_type(0.0f), float_type(0.0f), float_type(1.0f));
+                }
+
+                if (!lod || m_mipmap == mipmap_none || m_level_offsets.size() == 1)
+                {
+                    return sample_level(coord, base_level(), offset);
+                }
+
+                // clamped once more in level(), as NaNs go through min/max
+                float_type l = min(max(*lod, float_type(0.0f)), float_type(static_cast<float>(m_level_offsets.size() - 1)));
+
+                if (m_mipmap == mipmap_nearest)
+                {
+                    return sample_level(coord, level(uint_type(floor(l + 0.5f))), offset);
+                }
+
+                float_type l0 = floor(l);
+                uint_type i0(l0);
+                vec4_type a = sample_level(coord, level(i0), offset);
+                vec4_type b = sample_level(coord, level(i0 + uint_type(1u)), offset);
+                return a + (b - a) * (l - l0);
+            }
+
+            //! Probes are evenly spaced along the major axis, so that together they cover the footprint,
+            //! and all lanes take as many as the most anisotropic one needs; lanes needing fewer give the
+            //! rest zero weight. px2 and py2 are squared lengths of the gradients in texels.
+            vec4_type sample_anisotropic(const vec2_type& coord, const vec2_type& dPdx, const vec2_type& dPdy, const float_type& px2, const float_type& py2) const
+            {
+                using namespace std;
+                typedef detail::batch_traits<FloatType> traits;
+
+                // the bias keeps 0 / 0 out, a zero minor axis gets the most probes
+                float_type major2 = max(px2, py2);
+                float_type minor2 = min(px2, py2);
+                float_type count = min(ceil(sqrt(major2 / (minor2 + 1e-20f))), float_type(floor(m_max_anisotropy)));
+                count = max(count, float_type(1.0f));
+                float_type lod = log2(major2 / (count * count)) * 0.5f;
+
+                // step(edge, x) is x >= edge, so ties go to dPdx; either is as long then
+                float_type is_x = step(py2, px2);
+                vec2_type axis = dPdx * is_x + dPdy * (1.0f - is_x);
+
+                float counts[traits::size];
+                traits::store(count, counts);
+                const float most = *max_element(counts, counts + traits::size);
+
+                float_type inv_count = 1.0f / count;
+                vec4_type result(float_type(0.0f));
+                for (float i = 0.0f; i < most; i += 1.0f)
+                {
+                    float_type weight = min(max(count - i, float_type(0.0f)), float_type(1.0f)) * inv_count;
+                    float_type t = (float_type(i + 0.5f) * inv_count) - 0.5f;
+                    result += sample_lod(coord + axis * t, &lod) * weight;
+                }
+                return result;
+            }
+
+            level_lanes base_level() const
+            {
+                level_lanes result;
+                result.offset = uint_type(0u);
+                result.pitch = uint_type(m_level_pitches[0]);
+                result.max_x = uint_type(m_level_widths[0] - 1);
+                result.max_y = uint_type(m_level_heights[0] - 1);
+                result.width = float_type(static_cast<float>(m_level_widths[0]));
+                result.height = float_type(static_cast<float>(m_level_heights[0]));
+                return result;
+            }
+
+            //! Each lane may be at a different level, so the level descriptions are gathered too.
+            level_lanes level(const uint_type& index) const
+            {
+                using namespace std;
+                typedef detail::batch_traits<FloatType> traits;
+
+                uint_type i = level_index(index);
+                uint_type w = traits::gather(m_level_widths.data(), i);
+                uint_type h = traits::gather(m_level_heights.data(), i);
+
+                level_lanes result;
+                result.offset = traits::gather(m_level_offsets.data(), i);
+                result.pitch = traits::gather(m_level_pitches.data(), i);
+                result.max_x = w - uint_type(1u);
+                result.max_y = h - uint_type(1u);
+                result.width = float_type(w);
+                result.height = float_type(h);
+                return result;
+            }
+
+            uint_type level_index(const uint_type& index) const
+            {
+                using namespace std;
+                return min(index, uint_type(static_cast<unsigned>(m_level_offsets.size() - 1)));
+            }
+
+            vec4_type sample_level(const vec2_type& coord, const level_lanes& lvl, const ivec2_type* offset) const
+            {
+                using namespace std;
+
+                if (filter() == filter_nearest)
+                {
+                    float_type u = floor(coord.x * lvl.width);
+                    float_type v = floor(coord.y * lvl.height);
+                    if (offset)
+                    {
+                        u += float_type(offset->x);
+                        v += float_type(offset->y);
+                    }
+                    uint_type x = wrap_coord(u, lvl.width, lvl.max_x);
+                    uint_type y = wrap_coord(v, lvl.height, lvl.max_y);
+                    return fetch(row_index(lvl, y) + column_index(x));
+                }
+
+                footprint fp = bilinear_footprint(coord, lvl, offset);
+                uint_type ix0 = column_index(wrap_coord(fp.x0, lvl.width, lvl.max_x));
+                uint_type ix1 = column_index(wrap_coord(fp.x0 + 1.0f, lvl.width, lvl.max_x));
+                uint_type row0 = row_index(lvl, wrap_coord(fp.y0, lvl.height, lvl.max_y));
+                uint_type row1 = row_index(lvl, wrap_coord(fp.y0 + 1.0f, lvl.height, lvl.max_y));
+
+                vec4_type t00 = fetch(row0 + ix0);
+                vec4_type t10 = fetch(row0 + ix1);
+                vec4_type t01 = fetch(row1 + ix0);
+                vec4_type t11 = fetch(row1 + ix1);
+
+                vec4_type bottom = t00 + (t10 - t00) * fp.fx;
+                vec4_type top = t01 + (t11 - t01) * fp.fx;
+                return bottom + (top - bottom) * fp.fy;
+            }
+
+            footprint bilinear_footprint(const vec2_type& coord, const level_lanes& lvl, const ivec2_type* offset) const
+            {
+                using namespace std;
+
+                // texel centres are at halves
+                float_type u = coord.x * lvl.width - 0.5f;
+                float_type v = coord.y * lvl.height - 0.5f;
+
+                footprint result;
+                result.x0 = floor(u);
+                result.y0 = floor(v);
+                result.fx = u - result.x0;
+                result.fy = v - result.y0;
+                if (offset)
+                {
+                    result.x0 += float_type(offset->x);
+                    result.y0 += float_type(offset->y);
+                }
+                return result;
+            }
+
+            vec4_type gather_offset(const vec2_type& coord, const ivec2_type* offset, int comp) const
+            {
+                if (empty())
+                {
+                    // the component of (0, 0, 0, 1)
+                    return vec4_type(float_type(comp == 3 ? 1.0f : 0.0f));
+                }
+
+                const level_lanes lvl = base_level();
+                footprint fp = bilinear_footprint(coord, lvl, offset);
+                uint_type ix0 = column_index(wrap_coord(fp.x0, lvl.width, lvl.max_x));
+                uint_type ix1 = column_index(wrap_coord(fp.x0 + 1.0f, lvl.width, lvl.max_x));
+                uint_type row0 = row_index(lvl, wrap_coord(fp.y0, lvl.height, lvl.max_y));
+                uint_type row1 = row_index(lvl, wrap_coord(fp.y0 + 1.0f, lvl.height, lvl.max_y));
+
+                const size_t c = static_cast<size_t>(comp) & 3;
+                return vec4_type(fetch(row1 + ix0).at(c), fetch(row1 + ix1).at(c), fetch(row0 + ix1).at(c), fetch(row0 + ix0).at(c));
+            }
+
+            //! A texel's index is row_index(y) + column_index(x), in either layout, so that bilinear
+            //! filtering computes each only twice. Shifts and masks assume tile_size == 4.
+            uint_type row_index(const level_lanes& lvl, const uint_type& y) const
+            {
+                if (m_layout == layout_tiled)
+                {
+                    return lvl.offset + (y >> 2) * lvl.pitch + ((y & 3u) << 2);
+                }
+                return lvl.offset + y * lvl.pitch;
+            }
+
+            uint_type column_index(const uint_type& x) const
+            {
+                if (m_layout == layout_tiled)
+                {
+                    return ((x >> 2) << 4) + (x & 3u);
+                }
+                return x;
+            }
+
+            vec4_type fetch(const uint_type& index) const
+            {
+                using namespace std;
+
+                const std::uint32_t* words = texel_words();
+                const float* floats = texel_floats();
+                vec4_type result;
+
+                switch (m_format)
+                {
+                case format_rgba16f:
+                    {
+                        uint_type word = index << 1;
+                        unpackHalf2x16(gather_words(words, word), &result.at(0), &result.at(1));
+                        unpackHalf2x16(gather_words(words, word + uint_type(1u)), &result.at(2), &result.at(3));
+                    }
+                    break;
+                case format_rgba16f_planar:
+                    unpackHalf2x16(gather_words(words, index), &result.at(0), &result.at(1));
+                    unpackHalf2x16(gather_words(words + m_plane_size, index), &result.at(2), &result.at(3));
+                    break;
+                case format_rgba32f:
+                    {
+                        uint_type word = index << 2;
+                        result.at(0) = gather_floats(floats, word);
+                        result.at(1) = gather_floats(floats, word + uint_type(1u));
+                        result.at(2) = gather_floats(floats, word + uint_type(2u));
+                        result.at(3) = gather_floats(floats, word + uint_type(3u));
+                    }
+                    break;
+                case format_rgba32f_planar:
+                    result.at(0) = gather_floats(floats, index);
+                    result.at(1) = gather_floats(floats + m_plane_size, index);
+                    result.at(2) = gather_floats(floats + 2 * m_plane_size, index);
+                    result.at(3) = gather_floats(floats + 3 * m_plane_size, index);
+                    break;
+                case format_bc1:
+                    return fetch_compressed(index, &detail::block_compression::decode_bc1);
+                case format_bc3:
+                    return fetch_compressed(index, &detail::block_compression::decode_bc3);
+                case format_bc4:
+                    return fetch_compressed(index, &detail::block_compression::decode_bc4);
+                case format_bc5:
+                    return fetch_compressed(index, &detail::block_compression::decode_bc5);
+                case format_bc7:
+                    return fetch_compressed(index, &detail::block_compression::decode_bc7);
+                case format_rgba8:
+                default:
+                    unpackUnorm4x8(gather_words(words, index), &result.at(0), &result.at(1), &result.at(2), &result.at(3));
+                    break;
+                }
+                return result;
+            }
+
+            //! Blocks are 4x4 tiles, so index >> 4 is the block and index & 15 the texel within it. Lanes
+            //! go through the cache one by one, each reading its texel right away, as a later lane may
+            //! evict the block of an earlier one.
+            vec4_type fetch_compressed(const uint_type& index, void (*decode)(const std::uint8_t*, std::uint32_t*)) const
+            {
+                using namespace std;
+                typedef detail::batch_traits<FloatType> traits;
+
+                detail::decoded_block_cache& cache = detail::decoded_block_cache::get();
+                const std::uint8_t* blocks = reinterpret_cast<const std::uint8_t*>(texel_words());
+                const size_t bytes = block_bytes(m_format);
+
+                std::uint32_t lanes[traits::size];
+                traits::store(index, lanes);
+                for (size_t i = 0; i < traits::size; ++i)
+                {
+                    const std::uint32_t first = cache.find(m_cache_id, lanes[i] >> 4, [&](std::uint32_t block, std::uint32_t* texels) {
+                        if (m_mapped)
+                        {
+                            // blocks never straddle pages
+                            m_mapped->touch(blocks + block * bytes - m_mapped->data());
+                        }
+                        decode(blocks + block * bytes, texels);
+                    });
+                    lanes[i] = cache.texels[first + (lanes[i] & 15u)];
+                }
+
+                vec4_type result;
+                unpackUnorm4x8(traits::load(lanes), &result.at(0), &result.at(1), &result.at(2), &result.at(3));
+                return result;
+            }
+
+            //! Texels come from the mapped file, if there is one.
+            const std::uint32_t* texel_words() const
+            {
+                return m_mapped ? reinterpret_cast<const std::uint32_t*>(m_mapped->data() + m_data_offset) : m_texels.data();
+            }
+
+            const float* texel_floats() const
+            {
+                return m_mapped ? reinterpret_cast<const float*>(m_mapped->data() + m_data_offset) : m_float_texels.data();
+            }
+
+            //! Gathers, touching the pages of mapped texels first.
+            uint_type gather_words(const std::uint32_t* words, const uint_type& index) const
+            {
+                typedef detail::batch_traits<FloatType> traits;
+                if (m_mapped)
+                {
+                    touch(words, index);
+                }
+                return traits::gather(words, index);
+            }
+
+            float_type gather_floats(const float* floats, const uint_type& index) const
+            {
+                typedef detail::batch_traits<FloatType> traits;
+                if (m_mapped)
+                {
+                    touch(floats, index);
+                }
+                return traits::gather(floats, index);
+            }
+
+            //! Lanes of a footprint mostly share pages, so a lane only touches a page its predecessor did not.
+            void touch(const void* words, const uint_type& index) const
+            {
+                typedef detail::batch_traits<FloatType> traits;
+
+                std::uint32_t lanes[traits::size];
+                traits::store(index, lanes);
+                const size_t base = static_cast<const std::uint8_t*>(words) - m_mapped->data();
+                size_t last = static_cast<size_t>(-1);
+                for (size_t i = 0; i < traits::size; ++i)
+                {
+                    const size_t offset = base + static_cast<size_t>(lanes[i]) * sizeof(std::uint32_t);
+                    if ((offset >> detail::paged_memory::page_shift) != last)
+                    {
+                        m_mapped->touch(offset);
+                        last = offset >> detail::paged_memory::page_shift;
+                    }
+                }
+            }
+
+            //! 32 bit words of plane_size texels, or of plane_size / 16 blocks, in a format.
+            static size_t word_count(texel_format format, size_t plane_size)
+            {
+                switch (format)
+                {
+                case format_rgba16f:
+                case format_rgba16f_planar:
+                    return plane_size * 2;
+                case format_rgba32f:
+                case format_rgba32f_planar:
+                    return plane_size * 4;
+                case format_bc1:
+                case format_bc3:
+                case format_bc4:
+                case format_bc5:
+                case format_bc7:
+                    return plane_size / (tile_size * tile_size) * block_bytes(format) / sizeof(std::uint32_t);
+                case format_rgba8:
+                default:
+                    return plane_size;
+                }
+            }
+
+            static size_t block_bytes(texel_format format)
+            {
+                return (format == format_bc1 || format == format_bc4) ? 8 : 16;
+            }
+
+            static bool is_float(texel_format format)
+            {
+                return format == format_rgba32f || format == format_rgba32f_planar;
+            }
+
+            static bool is_compressed(texel_format format)
+            {
+                return format >= format_bc1;
+            }
+
+            bool empty() const
+            {
+                return m_plane_size == 0;
+            }
+
+            //! rgba holds 4 floats per texel of the base level; levels are appended to it, then it is
+            //! rearranged and encoded.
+            void build(size_t width, size_t height, std::vector<float>& rgba, texel_layout layout, texel_format format)
+            {
+                m_level_offsets.assign(1, 0);
+                m_level_widths.assign(1, static_cast<std::uint32_t>(width));
+                m_level_heights.assign(1, static_cast<std::uint32_t>(height));
+                m_level_pitches.assign(1, static_cast<std::uint32_t>(width));
+                m_layout = layout;
+                m_mapped.reset();
+                m_data_offset = 0;
+                // no encoders
+                m_format = is_compressed(format) ? format_rgba8 : format;
+                m_cache_id = 0;
+                if (width && height)
+                {
+                    generate_mipmaps(rgba);
+                    if (layout == layout_tiled)
+                    {
+                        tile(rgba);
+                    }
+                }
+                else
+                {
+                    rgba.clear();
+                }
+                encode(rgba);
+            }
+
+            //! Each level texel is the average of a 2x2 block of the previous level; odd sizes repeat the
+            //! last row/column.
+            void generate_mipmaps(std::vector<float>& rgba)
+            {
+                while (m_level_widths.back() > 1 || m_level_heights.back() > 1)
+                {
+                    const size_t src_offset = m_level_offsets.back();
+                    const size_t src_width = m_level_widths.back();
+                    const size_t src_height = m_level_heights.back();
+                    const size_t width = src_width > 1 ? src_width / 2 : 1;
+                    const size_t height = src_height > 1 ? src_height / 2 : 1;
+                    const size_t offset = rgba.size() / 4;
+
+                    rgba.resize((offset + width * height) * 4);
+                    for (size_t y = 0; y < height; ++y)
+                    {
+                        const float* row0 = &rgba[(src_offset + std::min(2 * y, src_height - 1) * src_width) * 4];
+                        const float* row1 = &rgba[(src_offset + std::min(2 * y + 1, src_height - 1) * src_width) * 4];
+                        for (size_t x = 0; x < width; ++x)
+                        {
+                            const size_t x0 = std::min(2 * x, src_width - 1) * 4;
+                            const size_t x1 = std::min(2 * x + 1, src_width - 1) * 4;
+                            float* dst = &rgba[(offset + y * width + x) * 4];
+                            for (size_t c = 0; c < 4; ++c)
+                            {
+                                dst[c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) * 0.25f;
+                            }
+                        }
+                    }
+
+                    m_level_offsets.push_back(static_cast<std::uint32_t>(offset));
+                    m_level_widths.push_back(static_cast<std::uint32_t>(width));
+                    m_level_heights.push_back(static_cast<std::uint32_t>(height));
+                    m_level_pitches.push_back(static_cast<std::uint32_t>(width));
+                }
+            }
+
+            //! Rearranges row-major levels into tiles; partial tiles are padded with edge texels, which are
+            //! never sampled.
+            void tile(std::vector<float>& rgba)
+            {
+                std::vector<float> tiled;
+                for (size_t level = 0; level < m_level_offsets.size(); ++level)
+                {
+                    const float* src = &rgba[m_level_offsets[level] * 4];
+                    const size_t width = m_level_widths[level];
+                    const size_t height = m_level_heights[level];
+                    size_t tiles_x = (width + tile_size - 1) / tile_size;
+                    if (tiles_x % 16 == 0)
+                    {
+                        // rows of tiles 1kB apart would keep landing in the same cache sets when walked vertically
+                        ++tiles_x;
+                    }
+                    const size_t tiles_y = (height + tile_size - 1) / tile_size;
+                    const size_t offset = tiled.size() / 4;
+
+                    tiled.resize((offset + tiles_x * tiles_y * tile_size * tile_size) * 4);
+                    for (size_t y = 0; y < tiles_y * tile_size; ++y)
+                    {
+                        for (size_t x = 0; x < tiles_x * tile_size; ++x)
+                        {
+                            const size_t tile_index = (y / tile_size) * tiles_x + x / tile_size;
+                            const size_t index = tile_index * tile_size * tile_size + (y % tile_size) * tile_size + x % tile_size;
+                            const float* texel = src + (std::min(y, height - 1) * width + std::min(x, width - 1)) * 4;
+                            std::copy(texel, texel + 4, &tiled[(offset + index) * 4]);
+                        }
+                    }
+
+                    m_level_offsets[level] = static_cast<std::uint32_t>(offset);
+                    m_level_pitches[level] = static_cast<std::uint32_t>(tiles_x * tile_size * tile_size);
+                }
+                rgba.swap(tiled);
+            }
+
+            void encode(const std::vector<float>& rgba)
+            {
+                const size_t count = rgba.size() / 4;
+                m_plane_size = count;
+                m_texels.clear();
+                m_float_texels.clear();
+
+                switch (m_format)
+                {
+                case format_rgba16f:
+                case format_rgba16f_planar:
+                    {
+                        const bool planar = m_format == format_rgba16f_planar;
+                        m_texels.resize(count * 2);
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            const float* texel = &rgba[i * 4];
+                            m_texels[planar ? i : i * 2] = std::packHalf2x16(texel[0], texel[1]);
+                            m_texels[planar ? count + i : i * 2 + 1] = std::packHalf2x16(texel[2], texel[3]);
+                        }
+                    }
+                    break;
+                case format_rgba32f:
+                    m_float_texels.assign(rgba.begin(), rgba.end());
+                    break;
+                case format_rgba32f_planar:
+                    m_float_texels.resize(count * 4);
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        for (size_t c = 0; c < 4; ++c)
+                        {
+                            m_float_texels[c * count + i] = rgba[i * 4 + c];
+                        }
+                    }
+                    break;
+                case format_rgba8:
+                default:
+                    m_texels.resize(count);
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        const float* texel = &rgba[i * 4];
+                        m_texels[i] = std::packUnorm4x8(texel[0], texel[1], texel[2], texel[3]);
+                    }
+                    break;
+                }
+            }
+
+        private:
+            //! All levels, one after another, in m_texels or, for float formats, in m_float_texels. Cache line
+            //! aligned, so that tiles do not straddle lines.
+            std::vector<std::uint32_t, detail::aligned_allocator<std::uint32_t, 64> > m_texels;
+            std::vector<float, detail::aligned_allocator<float, 64> > m_float_texels;
+            //! 32 bit, so that they can be gathered.
+            std::vector<std::uint32_t> m_level_offsets;
+            std::vector<std::uint32_t> m_level_widths;
+            std::vector<std::uint32_t> m_level_heights;
+            std::vector<std::uint32_t> m_level_pitches;
+            mipmap_mode m_mipmap;
+            float m_max_anisotropy;
+            texel_layout m_layout;
+            texel_format m_format;
+            //! Texel count, i.e. distance between planes of planar formats.
+            size_t m_plane_size;
+            //! Tells blocks of this texture apart in detail::decoded_block_cache.
+            std::uint32_t m_cache_id;
+            //! Set by assign_mapped; texels are then m_data_offset bytes into it, m_texels and
+            //! m_float_texels are empty.
+            std::shared_ptr<const detail::paged_memory> m_mapped;
+            size_t m_data_offset;
+        };
+    }
+}
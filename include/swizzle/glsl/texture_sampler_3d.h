@@ -0,0 +1,294 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <swizzle/glsl/texture_sampler.h>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! A 3D texture of RGBA8 texels (packUnorm4x8 layout), with nearest or trilinear (8 texel)
+        //! filtering and a single level. Like sampler2D, every lane addresses and filters on its own, so
+        //! a SIMD FloatType samples a whole batch of coordinates at once.
+        //! Texels can be stored in 4x4x4 bricks: neighbours along z are then at most 48 texels apart rather
+        //! than a whole slice, which helps footprints walking across slices. Lanes walking along x touch
+        //! more cache lines that way though, and row-major storage measured as fast or faster on the
+        //! whole, so it is the default.
+        template <class FloatType>
+        class sampler3D : public sampler_base
+        {
+        public:
+            typedef FloatType float_type;
+            typedef typename detail::get_int_scalar_type<FloatType>::type int_type;
+            typedef typename detail::get_uint_scalar_type<FloatType>::type uint_type;
+            typedef vector<FloatType, 3> vec3_type;
+            typedef vector<FloatType, 4> vec4_type;
+            typedef vector<int_type, 3> ivec3_type;
+            typedef const vec3_type& tex_coord_type;
+            typedef const ivec3_type& texel_coord_type;
+
+            enum texel_layout
+            {
+                layout_linear,
+                layout_bricked
+            };
+
+            static const texel_layout default_layout = layout_linear;
+
+            //! Bricks are brick_size^3 texels; x changes fastest inside, then y, then z.
+            static const unsigned brick_size = 4;
+            static_assert(brick_size == 4, "x_index, y_index and z_index need updating");
+
+        // CONSTRUCTION
+        public:
+
+            //! An empty texture; samples are (0, 0, 0, 1).
+            sampler3D(wrap_mode wrap = wrap_repeat, filter_mode filter = filter_linear)
+                : sampler_base(wrap, filter)
+                , m_layout(default_layout)
+                , m_width(0)
+                , m_height(0)
+                , m_depth(0)
+                , m_row_pitch(0)
+                , m_slice_pitch(0)
+            {}
+
+            sampler3D(size_t width, size_t height, size_t depth, const std::uint32_t* texels, wrap_mode wrap = wrap_repeat, filter_mode filter = filter_linear, texel_layout layout = default_layout)
+                : sampler_base(wrap, filter)
+            {
+                assign(width, height, depth, texels, layout);
+            }
+
+            //! Copies width * height * depth texels, x changing fastest, then y, then z.
+            void assign(size_t width, size_t height, size_t depth, const std::uint32_t* texels, texel_layout layout = default_layout)
+            {
+                m_layout = layout;
+                m_width = static_cast<std::uint32_t>(width);
+                m_height = static_cast<std::uint32_t>(height);
+                m_depth = static_cast<std::uint32_t>(depth);
+                m_texels.clear();
+
+                if (!width || !height || !depth)
+                {
+                    m_width = m_height = m_depth = 0;
+                    m_row_pitch = m_slice_pitch = 0;
+                    return;
+                }
+
+                if (layout == layout_linear)
+                {
+                    m_row_pitch = m_width;
+                    m_slice_pitch = m_width * m_height;
+                    m_texels.assign(texels, texels + width * height * depth);
+                    return;
+                }
+
+                const size_t bricks_x = (width + brick_size - 1) / brick_size;
+                const size_t bricks_y = (height + brick_size - 1) / brick_size;
+                const size_t bricks_z = (depth + brick_size - 1) / brick_size;
+                const size_t brick_texels = brick_size * brick_size * brick_size;
+                m_row_pitch = static_cast<std::uint32_t>(bricks_x * brick_texels);
+                m_slice_pitch = static_cast<std::uint32_t>(bricks_x * bricks_y * brick_texels);
+
+                // partial bricks are padded with edge texels, which are never sampled
+                m_texels.resize(bricks_x * bricks_y * bricks_z * brick_texels);
+                for (size_t z = 0; z < bricks_z * brick_size; ++z)
+                {
+                    for (size_t y = 0; y < bricks_y * brick_size; ++y)
+                    {
+                        for (size_t x = 0; x < bricks_x * brick_size; ++x)
+                        {
+                            const size_t src = (std::min(z, depth - 1) * height + std::min(y, height - 1)) * width + std::min(x, width - 1);
+                            m_texels[brick_x_index(x) + brick_y_index(y) + brick_z_index(z)] = texels[src];
+                        }
+                    }
+                }
+            }
+
+        // STATE
+        public:
+
+            size_t width() const
+            {
+                return m_width;
+            }
+
+            size_t height() const
+            {
+                return m_height;
+            }
+
+            size_t depth() const
+            {
+                return m_depth;
+            }
+
+            texel_layout layout() const
+            {
+                return m_layout;
+            }
+
+        // SAMPLING
+        public:
+
+            vec4_type sample(const vec3_type& coord) const
+            {
+                using namespace std;
+
+                if (empty())
+                {
+                    return vec4_type(float_type(0.0f), float_type(0.0f), float_type(0.0f), float_type(1.0f));
+                }
+
+                const float_type w(static_cast<float>(m_width));
+                const float_type h(static_cast<float>(m_height));
+                const float_type d(static_cast<float>(m_depth));
+                const uint_type max_x(m_width - 1);
+                const uint_type max_y(m_height - 1);
+                const uint_type max_z(m_depth - 1);
+
+                if (filter() == filter_nearest)
+                {
+                    uint_type x = wrap_coord(floor(coord.x * w), w, max_x);
+                    uint_type y = wrap_coord(floor(coord.y * h), h, max_y);
+                    uint_type z = wrap_coord(floor(coord.z * d), d, max_z);
+                    return fetch(x_index(x) + y_index(y) + z_index(z));
+                }
+
+                // texel centres are at halves
+                float_type u = coord.x * w - 0.5f;
+                float_type v = coord.y * h - 0.5f;
+                float_type s = coord.z * d - 0.5f;
+                float_type x0 = floor(u);
+                float_type y0 = floor(v);
+                float_type z0 = floor(s);
+                float_type fx = u - x0;
+                float_type fy = v - y0;
+                float_type fz = s - z0;
+
+                uint_type ix0 = x_index(wrap_coord(x0, w, max_x));
+                uint_type ix1 = x_index(wrap_coord(x0 + 1.0f, w, max_x));
+                uint_type iy0 = y_index(wrap_coord(y0, h, max_y));
+                uint_type iy1 = y_index(wrap_coord(y0 + 1.0f, h, max_y));
+                uint_type iz0 = z_index(wrap_coord(z0, d, max_z));
+                uint_type iz1 = z_index(wrap_coord(z0 + 1.0f, d, max_z));
+
+                vec4_type front = bilerp(ix0, ix1, iy0 + iz0, iy1 + iz0, fx, fy);
+                vec4_type back = bilerp(ix0, ix1, iy0 + iz1, iy1 + iz1, fx, fy);
+                return front + (back - front) * fz;
+            }
+
+            //! There is a single level, so lod is ignored. Out of range coordinates are clamped.
+            vec4_type fetchTexel(const ivec3_type& coord, const int_type&) const
+            {
+                using namespace std;
+
+                if (empty())
+                {
+                    return vec4_type(float_type(0.0f), float_type(0.0f), float_type(0.0f), float_type(1.0f));
+                }
+
+                uint_type x = min(uint_type(max(coord.x, int_type(0))), uint_type(m_width - 1));
+                uint_type y = min(uint_type(max(coord.y, int_type(0))), uint_type(m_height - 1));
+                uint_type z = min(uint_type(max(coord.z, int_type(0))), uint_type(m_depth - 1));
+                return fetch(x_index(x) + y_index(y) + z_index(z));
+            }
+
+            //! There is a single level, so lod is ignored.
+            ivec3_type size(const int_type&) const
+            {
+                return ivec3_type(int_type(static_cast<int>(m_width)), int_type(static_cast<int>(m_height)), int_type(static_cast<int>(m_depth)));
+            }
+
+        private:
+            //! Bilinear filtering within a slice; rows already include the slice index.
+            vec4_type bilerp(const uint_type& ix0, const uint_type& ix1, const uint_type& row0, const uint_type& row1, const float_type& fx, const float_type& fy) const
+            {
+                vec4_type t00 = fetch(row0 + ix0);
+                vec4_type t10 = fetch(row0 + ix1);
+                vec4_type t01 = fetch(row1 + ix0);
+                vec4_type t11 = fetch(row1 + ix1);
+
+                vec4_type bottom = t00 + (t10 - t00) * fx;
+                vec4_type top = t01 + (t11 - t01) * fx;
+                return bottom + (top - bottom) * fy;
+            }
+
+            //! A texel's index is x_index(x) + y_index(y) + z_index(z), in either layout, so that trilinear
+            //! filtering computes each only twice. Shifts and masks assume brick_size == 4.
+            uint_type x_index(const uint_type& x) const
+            {
+                if (m_layout == layout_bricked)
+                {
+                    return ((x >> 2) << 6) + (x & 3u);
+                }
+                return x;
+            }
+
+            uint_type y_index(const uint_type& y) const
+            {
+                if (m_layout == layout_bricked)
+                {
+                    return (y >> 2) * uint_type(m_row_pitch) + ((y & 3u) << 2);
+                }
+                return y * uint_type(m_row_pitch);
+            }
+
+            uint_type z_index(const uint_type& z) const
+            {
+                if (m_layout == layout_bricked)
+                {
+                    return (z >> 2) * uint_type(m_slice_pitch) + ((z & 3u) << 4);
+                }
+                return z * uint_type(m_slice_pitch);
+            }
+
+            //! Scalar versions of the above, for assign.
+            size_t brick_x_index(size_t x) const
+            {
+                return (x / brick_size) * brick_size * brick_size * brick_size + x % brick_size;
+            }
+
+            size_t brick_y_index(size_t y) const
+            {
+                return (y / brick_size) * m_row_pitch + (y % brick_size) * brick_size;
+            }
+
+            size_t brick_z_index(size_t z) const
+            {
+                return (z / brick_size) * m_slice_pitch + (z % brick_size) * brick_size * brick_size;
+            }
+
+            vec4_type fetch(const uint_type& index) const
+            {
+                using namespace std;
+                typedef detail::batch_traits<FloatType> traits;
+
+                vec4_type result;
+                unpackUnorm4x8(traits::gather(m_texels.data(), index), &result.at(0), &result.at(1), &result.at(2), &result.at(3));
+                return result;
+            }
+
+            bool empty() const
+            {
+                return m_texels.empty();
+            }
+
+        private:
+            //! Cache line aligned, so that bricks do not straddle lines.
+            std::vector<std::uint32_t, detail::aligned_allocator<std::uint32_t, 64> > m_texels;
+            texel_layout m_layout;
+            std::uint32_t m_width;
+            std::uint32_t m_height;
+            std::uint32_t m_depth;
+            //! Distance between rows and slices (of bricks, if bricked).
+            std::uint32_t m_row_pitch;
+            std::uint32_t m_slice_pitch;
+        };
+    }
+}
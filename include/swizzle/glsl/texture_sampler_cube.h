@@ -0,0 +1,345 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <swizzle/glsl/texture_sampler.h>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! A cube map of RGBA8 texels (packUnorm4x8 layout) with a box filtered mip chain per face.
+        //! Faces are selected per lane with arithmetic rather than branches, so that a SIMD FloatType looks
+        //! up a whole batch of directions, each possibly on a different face, at once.
+        //! Faces and their (s, t) orientation follow OpenGL; filtering does not cross face edges, i.e.
+        //! it is not seamless, and the wrap mode (clamp by default) applies within a face.
+        template <class FloatType>
+        class samplerCube : public sampler_base
+        {
+        public:
+            typedef FloatType float_type;
+            typedef typename detail::get_int_scalar_type<FloatType>::type int_type;
+            typedef typename detail::get_uint_scalar_type<FloatType>::type uint_type;
+            typedef vector<FloatType, 2> vec2_type;
+            typedef vector<FloatType, 3> vec3_type;
+            typedef vector<FloatType, 4> vec4_type;
+            typedef vector<int_type, 2> ivec2_type;
+            typedef const vec3_type& tex_coord_type;
+
+            //! Order of faces in memory, same as GL_TEXTURE_CUBE_MAP_POSITIVE_X onwards.
+            enum face
+            {
+                face_positive_x,
+                face_negative_x,
+                face_positive_y,
+                face_negative_y,
+                face_positive_z,
+                face_negative_z,
+                face_count
+            };
+
+        // CONSTRUCTION
+        public:
+
+            //! An empty texture; samples are (0, 0, 0, 1).
+            samplerCube(filter_mode filter = filter_linear, mipmap_mode mipmap = mipmap_linear, wrap_mode wrap = wrap_clamp)
+                : sampler_base(wrap, filter)
+                , m_mipmap(mipmap)
+            {}
+
+            samplerCube(size_t size, const std::uint32_t* faces, filter_mode filter = filter_linear, mipmap_mode mipmap = mipmap_linear, wrap_mode wrap = wrap_clamp)
+                : sampler_base(wrap, filter)
+                , m_mipmap(mipmap)
+            {
+                assign(size, faces);
+            }
+
+            //! faces holds face_count size x size row-major faces, one after another, in face order.
+            void assign(size_t size, const std::uint32_t* faces)
+            {
+                m_texels.clear();
+                m_level_offsets.clear();
+                m_level_sizes.clear();
+                if (!size)
+                {
+                    return;
+                }
+
+                m_texels.assign(faces, faces + face_count * size * size);
+                m_level_offsets.push_back(0);
+                m_level_sizes.push_back(static_cast<std::uint32_t>(size));
+                generate_mipmaps();
+            }
+
+        // STATE
+        public:
+
+            //! Width and height of a face of the base level.
+            size_t size() const
+            {
+                return m_level_sizes.empty() ? 0 : m_level_sizes[0];
+            }
+
+            size_t levels() const
+            {
+                return m_level_sizes.size();
+            }
+
+            mipmap_mode mipmap() const
+            {
+                return m_mipmap;
+            }
+
+            void mipmap(mipmap_mode value)
+            {
+                m_mipmap = value;
+            }
+
+        // SAMPLING
+        public:
+
+            //! There are no implicit derivatives, so the base level is sampled (or the bias one).
+            vec4_type sample(const vec3_type& dir) const
+            {
+                return sample_lod(dir, nullptr);
+            }
+
+            vec4_type sample(const vec3_type& dir, const float_type& bias) const
+            {
+                return sample_lod(dir, &bias);
+            }
+
+            vec4_type sampleLod(const vec3_type& dir, const float_type& lod) const
+            {
+                return sample_lod(dir, &lod);
+            }
+
+            //! Face dimensions of a level; lod is clamped to existing levels.
+            ivec2_type size(const int_type& lod) const
+            {
+                using namespace std;
+                typedef detail::batch_traits<FloatType> traits;
+
+                if (empty())
+                {
+                    return ivec2_type(int_type(0), int_type(0));
+                }
+
+                int_type s(traits::gather(m_level_sizes.data(), level_index(uint_type(max(lod, int_type(0))))));
+                return ivec2_type(s, s);
+            }
+
+        private:
+            //! Per-lane description of a mip level of the selected face.
+            struct level_lanes
+            {
+                uint_type offset;
+                uint_type pitch;
+                uint_type max_index;
+                float_type size;
+            };
+
+            //! Per-lane face and coordinates within it, in [0, 1].
+            struct face_coord
+            {
+                uint_type face;
+                float_type s;
+                float_type t;
+            };
+
+            //! Major axis selection of the OpenGL spec, as arithmetic: each is* is 0 or 1 and exactly one
+            //! of them is set. step(edge, x) is x > edge here, so ties go to z, then to y.
+            face_coord select_face(const vec3_type& dir) const
+            {
+                using namespace std;
+
+                float_type ax = abs(dir.x);
+                float_type ay = abs(dir.y);
+                float_type az = abs(dir.z);
+                float_type is_x = step(ay, ax) * step(az, ax);
+                float_type is_y = (1.0f - is_x) * step(az, ay);
+                float_type is_z = (1.0f - is_x) - is_y;
+
+                // 1 for negative components, 0 otherwise
+                float_type neg_x = 1.0f - step(float_type(0.0f), dir.x);
+                float_type neg_y = 1.0f - step(float_type(0.0f), dir.y);
+                float_type neg_z = 1.0f - step(float_type(0.0f), dir.z);
+
+                //        sc      tc      ma
+                // +x     -z      -y      x
+                // -x     +z      -y      x
+                // +y     +x      +z      y
+                // -y     +x      -z      y
+                // +z     +x      -y      z
+                // -z     -x      -y      z
+                float_type sc = is_x * (dir.z * (neg_x * 2.0f - 1.0f)) + is_y * dir.x + is_z * (dir.x * (1.0f - neg_z * 2.0f));
+                float_type tc = is_y * (dir.z * (1.0f - neg_y * 2.0f)) - (1.0f - is_y) * dir.y;
+                float_type ma = is_x * ax + is_y * ay + is_z * az;
+
+                face_coord result;
+                result.face = uint_type(is_x * neg_x + is_y * (2.0f + neg_y) + is_z * (4.0f + neg_z));
+                result.s = (sc / ma + 1.0f) * 0.5f;
+                result.t = (tc / ma + 1.0f) * 0.5f;
+                return result;
+            }
+
+            vec4_type sample_lod(const vec3_type& dir, const float_type* lod) const
+            {
+                using namespace std;
+
+                if (empty())
+                {
+                    return vec4_type(float_type(0.0f), float_type(0.0f), float_type(0.0f), float_type(1.0f));
+                }
+
+                const face_coord fc = select_face(dir);
+                if (!lod || m_mipmap == mipmap_none || m_level_sizes.size() == 1)
+                {
+                    return sample_level(fc, level(fc.face, uint_type(0u)));
+                }
+
+                // clamped once more in level(), as NaNs go through min/max
+                float_type l = min(max(*lod, float_type(0.0f)), float_type(static_cast<float>(m_level_sizes.size() - 1)));
+
+                if (m_mipmap == mipmap_nearest)
+                {
+                    return sample_level(fc, level(fc.face, uint_type(floor(l + 0.5f))));
+                }
+
+                float_type l0 = floor(l);
+                uint_type i0(l0);
+                vec4_type a = sample_level(fc, level(fc.face, i0));
+                vec4_type b = sample_level(fc, level(fc.face, i0 + uint_type(1u)));
+                return a + (b - a) * (l - l0);
+            }
+
+            uint_type level_index(const uint_type& index) const
+            {
+                using namespace std;
+                return min(index, uint_type(static_cast<unsigned>(m_level_sizes.size() - 1)));
+            }
+
+            //! Faces of a level are size * size texels each, one after another.
+            level_lanes level(const uint_type& face, const uint_type& index) const
+            {
+                typedef detail::batch_traits<FloatType> traits;
+
+                uint_type i = level_index(index);
+                uint_type size = traits::gather(m_level_sizes.data(), i);
+
+                level_lanes result;
+                result.offset = traits::gather(m_level_offsets.data(), i) + face * size * size;
+                result.pitch = size;
+                result.max_index = size - uint_type(1u);
+                result.size = float_type(size);
+                return result;
+            }
+
+            vec4_type sample_level(const face_coord& fc, const level_lanes& lvl) const
+            {
+                using namespace std;
+
+                if (filter() == filter_nearest)
+                {
+                    uint_type x = wrap_coord(floor(fc.s * lvl.size), lvl.size, lvl.max_index);
+                    uint_type y = wrap_coord(floor(fc.t * lvl.size), lvl.size, lvl.max_index);
+                    return fetch(lvl.offset + y * lvl.pitch + x);
+                }
+
+                // texel centres are at halves
+                float_type u = fc.s * lvl.size - 0.5f;
+                float_type v = fc.t * lvl.size - 0.5f;
+                float_type x0 = floor(u);
+                float_type y0 = floor(v);
+                float_type fx = u - x0;
+                float_type fy = v - y0;
+
+                uint_type ix0 = wrap_coord(x0, lvl.size, lvl.max_index);
+                uint_type ix1 = wrap_coord(x0 + 1.0f, lvl.size, lvl.max_index);
+                uint_type row0 = lvl.offset + wrap_coord(y0, lvl.size, lvl.max_index) * lvl.pitch;
+                uint_type row1 = lvl.offset + wrap_coord(y0 + 1.0f, lvl.size, lvl.max_index) * lvl.pitch;
+
+                vec4_type t00 = fetch(row0 + ix0);
+                vec4_type t10 = fetch(row0 + ix1);
+                vec4_type t01 = fetch(row1 + ix0);
+                vec4_type t11 = fetch(row1 + ix1);
+
+                vec4_type bottom = t00 + (t10 - t00) * fx;
+                vec4_type top = t01 + (t11 - t01) * fx;
+                return bottom + (top - bottom) * fy;
+            }
+
+            vec4_type fetch(const uint_type& index) const
+            {
+                using namespace std;
+                typedef detail::batch_traits<FloatType> traits;
+
+                vec4_type result;
+                unpackUnorm4x8(traits::gather(m_texels.data(), index), &result.at(0), &result.at(1), &result.at(2), &result.at(3));
+                return result;
+            }
+
+            bool empty() const
+            {
+                return m_level_sizes.empty();
+            }
+
+            //! Each face is filtered on its own; a level texel is the average of a 2x2 block of the
+            //! previous level, odd sizes repeating the last row/column.
+            void generate_mipmaps()
+            {
+                while (m_level_sizes.back() > 1)
+                {
+                    const size_t src_offset = m_level_offsets.back();
+                    const size_t src_size = m_level_sizes.back();
+                    const size_t size = src_size / 2;
+                    const size_t offset = m_texels.size();
+
+                    m_texels.resize(offset + face_count * size * size);
+                    for (size_t f = 0; f < face_count; ++f)
+                    {
+                        const std::uint32_t* src = &m_texels[src_offset + f * src_size * src_size];
+                        std::uint32_t* dst = &m_texels[offset + f * size * size];
+                        for (size_t y = 0; y < size; ++y)
+                        {
+                            const std::uint32_t* row0 = src + (2 * y) * src_size;
+                            const std::uint32_t* row1 = src + std::min(2 * y + 1, src_size - 1) * src_size;
+                            for (size_t x = 0; x < size; ++x)
+                            {
+                                const size_t x0 = 2 * x;
+                                const size_t x1 = std::min(2 * x + 1, src_size - 1);
+                                float sum[4] = { 0, 0, 0, 0 };
+                                const std::uint32_t block[] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+                                for (std::uint32_t texel : block)
+                                {
+                                    float rgba[4];
+                                    std::unpackUnorm4x8(texel, &rgba[0], &rgba[1], &rgba[2], &rgba[3]);
+                                    for (size_t c = 0; c < 4; ++c)
+                                    {
+                                        sum[c] += rgba[c];
+                                    }
+                                }
+                                dst[y * size + x] = std::packUnorm4x8(sum[0] * 0.25f, sum[1] * 0.25f, sum[2] * 0.25f, sum[3] * 0.25f);
+                            }
+                        }
+                    }
+
+                    m_level_offsets.push_back(static_cast<std::uint32_t>(offset));
+                    m_level_sizes.push_back(static_cast<std::uint32_t>(size));
+                }
+            }
+
+        private:
+            //! All levels, one after another, each with face_count faces. Cache line aligned.
+            std::vector<std::uint32_t, detail::aligned_allocator<std::uint32_t, 64> > m_texels;
+            //! 32 bit, so that they can be gathered.
+            std::vector<std::uint32_t> m_level_offsets;
+            std::vector<std::uint32_t> m_level_sizes;
+            mipmap_mode m_mipmap;
+        };
+    }
+}
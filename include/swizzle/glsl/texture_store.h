@@ -0,0 +1,303 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <swizzle/detail/paged_memory.h>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! Maps texture files (see sampler2D::save) into memory, so that opening one is next to free and
+        //! only pages actually sampled are ever read from disk. Pages are tracked across all files of a
+        //! store: once more than budget() bytes have been touched, the least recently used ones are
+        //! dropped from the process (madvise / VirtualUnlock) until a quarter of the budget is free again.
+        //! The working set stays bounded while the files stay mapped; dropped pages fault back in when
+        //! sampled again. Thread safe; a store needs to outlive handles it returned.
+        class texture_store
+        {
+        public:
+            typedef std::shared_ptr<const detail::paged_memory> handle;
+
+            static const size_t default_budget = static_cast<size_t>(256) << 20;
+
+            explicit texture_store(size_t budget = default_budget)
+                : m_budget(budget)
+                , m_resident(0)
+                , m_clock(1)
+            {}
+
+            //! The one samplers normally use; as a function static it is constructed on first use and
+            //! so outlives global samplers holding its handles.
+            static texture_store& global()
+            {
+                static texture_store store;
+                return store;
+            }
+
+            size_t budget() const
+            {
+                return m_budget.load(std::memory_order_relaxed);
+            }
+
+            //! Takes effect on the next fault.
+            void budget(size_t bytes)
+            {
+                m_budget.store(bytes, std::memory_order_relaxed);
+            }
+
+            //! Bytes of pages touched and not evicted since.
+            size_t resident() const
+            {
+                return m_resident.load(std::memory_order_relaxed);
+            }
+
+            //! Null if the file can not be opened or mapped, or is empty.
+            handle open(const char* path)
+            {
+                std::shared_ptr<mapped_file> file(new mapped_file(*this));
+                if (!file->map(path))
+                {
+                    return handle();
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_files.push_back(file.get());
+                return file;
+            }
+
+        private:
+            class mapped_file : public detail::paged_memory
+            {
+            public:
+                explicit mapped_file(texture_store& store)
+                    : paged_memory(nullptr, 0, &store.m_clock)
+                    , m_store(store)
+#if defined(_WIN32)
+                    , m_file(INVALID_HANDLE_VALUE)
+                    , m_mapping(nullptr)
+#endif
+                {}
+
+                ~mapped_file()
+                {
+                    if (m_data)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(m_store.m_mutex);
+                            auto it = std::find(m_store.m_files.begin(), m_store.m_files.end(), this);
+                            if (it != m_store.m_files.end())
+                            {
+                                m_store.m_files.erase(it);
+                            }
+                            for (size_t i = 0; i < page_count(); ++i)
+                            {
+                                if (m_stamps[i].load(std::memory_order_relaxed))
+                                {
+                                    m_store.m_resident.fetch_sub(page_size, std::memory_order_relaxed);
+                                }
+                            }
+                        }
+#if defined(_WIN32)
+                        UnmapViewOfFile(m_data);
+#else
+                        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+                    }
+#if defined(_WIN32)
+                    if (m_mapping)
+                    {
+                        CloseHandle(m_mapping);
+                    }
+                    if (m_file != INVALID_HANDLE_VALUE)
+                    {
+                        CloseHandle(m_file);
+                    }
+#endif
+                }
+
+                bool map(const char* path)
+                {
+#if defined(_WIN32)
+                    m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                    if (m_file == INVALID_HANDLE_VALUE)
+                    {
+                        return false;
+                    }
+                    LARGE_INTEGER size;
+                    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0 || static_cast<unsigned long long>(size.QuadPart) > static_cast<size_t>(-1))
+                    {
+                        return false;
+                    }
+                    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                    if (!m_mapping)
+                    {
+                        return false;
+                    }
+                    void* data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+                    if (!data)
+                    {
+                        return false;
+                    }
+                    reset(static_cast<const std::uint8_t*>(data), static_cast<size_t>(size.QuadPart));
+#else
+                    int fd = ::open(path, O_RDONLY);
+                    if (fd < 0)
+                    {
+                        return false;
+                    }
+                    struct stat info;
+                    void* data = MAP_FAILED;
+                    if (fstat(fd, &info) == 0 && info.st_size > 0)
+                    {
+                        data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                    }
+                    // the mapping keeps the file alive
+                    close(fd);
+                    if (data == MAP_FAILED)
+                    {
+                        return false;
+                    }
+                    reset(static_cast<const std::uint8_t*>(data), static_cast<size_t>(info.st_size));
+#endif
+                    return true;
+                }
+
+                //! Drops a page from the working set; stamp is the one it was chosen by, so that a page
+                //! touched in the meantime stays.
+                void evict(size_t page, std::uint32_t stamp)
+                {
+                    if (!m_stamps[page].compare_exchange_strong(stamp, 0, std::memory_order_relaxed))
+                    {
+                        return;
+                    }
+
+                    const size_t offset = page << page_shift;
+                    const size_t bytes = m_size - offset < page_size ? m_size - offset : page_size;
+#if defined(_WIN32)
+                    // removes unlocked pages from the working set, even though it "fails" for them
+                    VirtualUnlock(const_cast<std::uint8_t*>(m_data + offset), bytes);
+#else
+                    madvise(const_cast<std::uint8_t*>(m_data + offset), bytes, MADV_DONTNEED);
+#endif
+                    m_store.m_resident.fetch_sub(page_size, std::memory_order_relaxed);
+                }
+
+                std::uint32_t stamp(size_t page) const
+                {
+                    return m_stamps[page].load(std::memory_order_relaxed);
+                }
+
+            private:
+                void reset(const std::uint8_t* data, size_t size)
+                {
+                    m_data = data;
+                    m_size = size;
+                    m_stamps.reset(new std::atomic<std::uint32_t>[page_count()]);
+                    for (size_t i = 0; i < page_count(); ++i)
+                    {
+                        m_stamps[i].store(0, std::memory_order_relaxed);
+                    }
+                }
+
+                void fault(size_t) const override
+                {
+                    m_store.fault();
+                }
+
+                texture_store& m_store;
+#if defined(_WIN32)
+                HANDLE m_file;
+                HANDLE m_mapping;
+#endif
+            };
+
+            struct page_ref
+            {
+                std::uint32_t stamp;
+                mapped_file* file;
+                size_t page;
+
+                bool operator<(const page_ref& other) const
+                {
+                    return stamp < other.stamp;
+                }
+            };
+
+            //! Every fault moves the clock, so pages touched since the last one are the most recent.
+            void fault()
+            {
+                if (m_clock.fetch_add(1, std::memory_order_relaxed) + 1 == 0)
+                {
+                    // wrapped around, after 4 billion faults; 0 means "not resident"
+                    m_clock.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (m_resident.fetch_add(detail::paged_memory::page_size, std::memory_order_relaxed) + detail::paged_memory::page_size > budget())
+                {
+                    evict();
+                }
+            }
+
+            //! One thread evicts at a time; others keep faulting in, going over the budget briefly.
+            void evict()
+            {
+                std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+                if (!lock)
+                {
+                    return;
+                }
+
+                std::vector<page_ref> pages;
+                for (mapped_file* file : m_files)
+                {
+                    for (size_t i = 0; i < file->page_count(); ++i)
+                    {
+                        page_ref ref = { file->stamp(i), file, i };
+                        if (ref.stamp)
+                        {
+                            pages.push_back(ref);
+                        }
+                    }
+                }
+                std::sort(pages.begin(), pages.end());
+
+                const size_t target = budget() / 4 * 3;
+                for (size_t i = 0; i < pages.size() && resident() > target; ++i)
+                {
+                    pages[i].file->evict(pages[i].page, pages[i].stamp);
+                }
+            }
+
+        private:
+            std::mutex m_mutex;
+            //! Guarded by m_mutex.
+            std::vector<mapped_file*> m_files;
+            std::atomic<size_t> m_budget;
+            std::atomic<size_t> m_resident;
+            std::atomic<std::uint32_t> m_clock;
+        };
+    }
+}
@@ -0,0 +1,268 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! Draws a frame in tiles on all OpenMP threads (or the calling one, without OpenMP), balancing
+        //! the load by work stealing: each thread starts with a contiguous run of tiles, so that
+        //! neighbours sharing cache lines of the target mostly stay on one thread, and takes them from
+        //! the front; a thread that runs out takes the back half of the longest run left, i.e. the tiles
+        //! farthest from where its owner is working. A run is a [begin, end) range packed into a single
+        //! atomic, so both ends are taken with a CAS and no locks.
+        //! Cancelling is checked before every tile; tiles are always drawn in whole.
+        class tile_scheduler
+        {
+        public:
+            //! In pixels of the target, rows top-down.
+            struct tile
+            {
+                size_t x;
+                size_t y;
+                size_t width;
+                size_t height;
+            };
+
+            //! Of a single thread during the last run.
+            struct thread_stats
+            {
+                //! Time spent drawing, as opposed to looking for work or waiting for other threads.
+                double busy_seconds;
+                size_t tiles;
+                size_t steals;
+            };
+
+            static const size_t default_tile_size = 32;
+
+            explicit tile_scheduler(size_t tile_width = default_tile_size, size_t tile_height = default_tile_size)
+                : m_tile_width(tile_width ? tile_width : 1)
+                , m_tile_height(tile_height ? tile_height : 1)
+                , m_queue_count(0)
+                , m_seconds(0)
+            {}
+
+            size_t tile_width() const
+            {
+                return m_tile_width;
+            }
+
+            size_t tile_height() const
+            {
+                return m_tile_height;
+            }
+
+            //! Calls draw(tile, thread) for every tile of a width x height frame, thread being the index of
+            //! the calling thread, less than stats().size(), so that per-thread state can be kept outside.
+            //! Stops early, returning false, once cancelled() returns true; it is called before each tile,
+            //! from all threads.
+            template <class Draw, class Cancelled>
+            bool run(size_t width, size_t height, Draw draw, Cancelled cancelled)
+            {
+                typedef std::chrono::steady_clock clock;
+
+                const size_t columns = (width + m_tile_width - 1) / m_tile_width;
+                const size_t count = columns * ((height + m_tile_height - 1) / m_tile_height);
+#ifdef _OPENMP
+                const size_t threads = static_cast<size_t>(omp_get_max_threads());
+#else
+                const size_t threads = 1;
+#endif
+                reserve(threads);
+                m_stats.assign(threads, thread_stats());
+                std::atomic<bool> stopped(false);
+
+                const clock::time_point start = clock::now();
+#ifdef _OPENMP
+#pragma omp parallel if(count > 1)
+#endif
+                {
+#ifdef _OPENMP
+                    const size_t thread = static_cast<size_t>(omp_get_thread_num());
+                    const size_t team = static_cast<size_t>(omp_get_num_threads());
+#else
+                    const size_t thread = 0;
+                    const size_t team = 1;
+#endif
+                    m_queues[thread].range.store(pack(count * thread / team, count * (thread + 1) / team), std::memory_order_relaxed);
+#ifdef _OPENMP
+#pragma omp barrier
+#endif
+                    thread_stats& stats = m_stats[thread];
+                    size_t index;
+                    while (!stopped.load(std::memory_order_relaxed) && (take(thread, index) || steal(thread, team, stats, index)))
+                    {
+                        if (cancelled())
+                        {
+                            stopped.store(true, std::memory_order_relaxed);
+                            break;
+                        }
+
+                        tile t;
+                        t.x = (index % columns) * m_tile_width;
+                        t.y = (index / columns) * m_tile_height;
+                        t.width = width - t.x < m_tile_width ? width - t.x : m_tile_width;
+                        t.height = height - t.y < m_tile_height ? height - t.y : m_tile_height;
+
+                        const clock::time_point begin = clock::now();
+                        draw(t, thread);
+                        stats.busy_seconds += std::chrono::duration<double>(clock::now() - begin).count();
+                        ++stats.tiles;
+                    }
+                }
+                m_seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+                return !stopped.load(std::memory_order_relaxed);
+            }
+
+            template <class Draw>
+            bool run(size_t width, size_t height, Draw draw)
+            {
+                return run(width, height, draw, []() { return false; });
+            }
+
+            //! One entry per thread that could have taken part in the last run.
+            const std::vector<thread_stats>& stats() const
+            {
+                return m_stats;
+            }
+
+            //! Wall time of the last run.
+            double seconds() const
+            {
+                return m_seconds;
+            }
+
+            //! Average busy time over the longest one, 1 for a perfectly even split; 1 before any run.
+            double balance() const
+            {
+                return balance(m_stats);
+            }
+
+            //! As above, for stats copied elsewhere.
+            static double balance(const std::vector<thread_stats>& stats)
+            {
+                double total = 0, longest = 0;
+                for (const thread_stats& s : stats)
+                {
+                    total += s.busy_seconds;
+                    longest = s.busy_seconds > longest ? s.busy_seconds : longest;
+                }
+                return longest > 0 ? total / stats.size() / longest : 1.0;
+            }
+
+        private:
+            //! A cache line each, so that threads taking from their own runs do not disturb each other.
+            struct queue
+            {
+                std::atomic<std::uint64_t> range;
+                char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+            };
+
+            static std::uint64_t pack(size_t begin, size_t end)
+            {
+                return (static_cast<std::uint64_t>(begin) << 32) | static_cast<std::uint64_t>(end);
+            }
+
+            static size_t begin_of(std::uint64_t range)
+            {
+                return static_cast<size_t>(range >> 32);
+            }
+
+            static size_t end_of(std::uint64_t range)
+            {
+                return static_cast<size_t>(range & 0xffffffffu);
+            }
+
+            void reserve(size_t threads)
+            {
+                if (m_queue_count < threads)
+                {
+                    m_queues.reset(new queue[threads]);
+                    m_queue_count = threads;
+                }
+                for (size_t i = 0; i < m_queue_count; ++i)
+                {
+                    m_queues[i].range.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            //! From the front of the thread's own run.
+            bool take(size_t thread, size_t& index)
+            {
+                std::atomic<std::uint64_t>& range = m_queues[thread].range;
+                std::uint64_t current = range.load(std::memory_order_relaxed);
+                while (begin_of(current) < end_of(current))
+                {
+                    if (range.compare_exchange_weak(current, pack(begin_of(current) + 1, end_of(current)), std::memory_order_relaxed))
+                    {
+                        index = begin_of(current);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            //! Moves the back half of the longest other run to the thread's own (empty) one and takes the
+            //! first tile of it. False once all runs are empty; a run being moved at that moment is taken
+            //! care of by the thread moving it.
+            bool steal(size_t thread, size_t team, thread_stats& stats, size_t& index)
+            {
+                for (;;)
+                {
+                    size_t victim = team;
+                    size_t longest = 0;
+                    for (size_t i = 0; i < team; ++i)
+                    {
+                        const std::uint64_t current = m_queues[i].range.load(std::memory_order_relaxed);
+                        if (i != thread && end_of(current) - begin_of(current) > longest)
+                        {
+                            longest = end_of(current) - begin_of(current);
+                            victim = i;
+                        }
+                    }
+                    if (victim == team)
+                    {
+                        return false;
+                    }
+
+                    std::atomic<std::uint64_t>& range = m_queues[victim].range;
+                    std::uint64_t current = range.load(std::memory_order_relaxed);
+                    const size_t begin = begin_of(current), end = end_of(current);
+                    if (begin >= end)
+                    {
+                        continue;
+                    }
+                    const size_t middle = end - (end - begin + 1) / 2;
+                    if (range.compare_exchange_strong(current, pack(begin, middle), std::memory_order_relaxed))
+                    {
+                        // nothing takes from an empty run, so a plain store does
+                        m_queues[thread].range.store(pack(middle + 1, end), std::memory_order_relaxed);
+                        ++stats.steals;
+                        index = middle;
+                        return true;
+                    }
+                }
+            }
+
+            size_t m_tile_width;
+            size_t m_tile_height;
+            std::unique_ptr<queue[]> m_queues;
+            size_t m_queue_count;
+            std::vector<thread_stats> m_stats;
+            double m_seconds;
+        };
+    }
+}
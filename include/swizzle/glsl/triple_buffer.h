@@ -0,0 +1,79 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+#pragma once
+
+#include <atomic>
+
+namespace swizzle
+{
+    namespace glsl
+    {
+        //! Hands values over from one thread to another without locks and without either ever waiting:
+        //! the writer fills back() and publishes it, the reader picks the latest published value up with
+        //! update() and reads front(). The third buffer sits between them, holding the latest published
+        //! value until the reader takes it or the writer replaces it, so the writer always has a free
+        //! buffer and the reader is never more than one value behind. Values published in between two
+        //! updates are skipped.
+        //! Buffers are swapped, not copied; once published, a back buffer comes back to the writer with
+        //! whatever it held before (e.g. an older frame), to be reused or overwritten.
+        template <class T>
+        class triple_buffer
+        {
+        public:
+            triple_buffer()
+                : m_buffers()
+                , m_back(0)
+                , m_middle(1)
+                , m_front(2)
+            {}
+
+            //! The writer's buffer.
+            T& back()
+            {
+                return m_buffers[m_back];
+            }
+
+            //! Makes the back buffer the latest value and gives the writer another one.
+            void publish()
+            {
+                m_back = m_middle.exchange(m_back | fresh_flag, std::memory_order_acq_rel) & index_mask;
+            }
+
+            //! Takes the latest published value, if there is one the reader has not taken yet; false
+            //! otherwise, leaving front() as it was.
+            bool update()
+            {
+                if (!(m_middle.load(std::memory_order_relaxed) & fresh_flag))
+                {
+                    return false;
+                }
+                // only the writer touches it in the meantime, and it can only keep it fresh
+                m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & index_mask;
+                return true;
+            }
+
+            //! The reader's buffer, value-initialised until the first update().
+            T& front()
+            {
+                return m_buffers[m_front];
+            }
+
+            const T& front() const
+            {
+                return m_buffers[m_front];
+            }
+
+        private:
+            static const unsigned index_mask = 3;
+            static const unsigned fresh_flag = 4;
+
+            T m_buffers[3];
+            //! Touched by the writer only.
+            unsigned m_back;
+            //! Index of the buffer in between, fresh_flag set if published and not taken yet.
+            std::atomic<unsigned> m_middle;
+            //! Touched by the reader only.
+            unsigned m_front;
+        };
+    }
+}
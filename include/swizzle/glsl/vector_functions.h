@@ -53,15 +53,35 @@ SWIZZLE_FORWARD_FUNC(abs)
 SWIZZLE_FORWARD_FUNC(sign)
 SWIZZLE_FORWARD_FUNC(floor)
 SWIZZLE_FORWARD_FUNC(ceil)
+SWIZZLE_FORWARD_FUNC(trunc)
+SWIZZLE_FORWARD_FUNC(round)
+SWIZZLE_FORWARD_FUNC(roundEven)
 SWIZZLE_FORWARD_FUNC(fract)
 SWIZZLE_FORWARD_FUNC(mod)
+SWIZZLE_FORWARD_FUNC(modf)
 SWIZZLE_FORWARD_FUNC(min)
 SWIZZLE_FORWARD_FUNC(max)
 SWIZZLE_FORWARD_FUNC(clamp)
 SWIZZLE_FORWARD_FUNC(mix)
 SWIZZLE_FORWARD_FUNC(step)
 SWIZZLE_FORWARD_FUNC(smoothstep)
+SWIZZLE_FORWARD_FUNC(isnan)
+SWIZZLE_FORWARD_FUNC(isinf)
+SWIZZLE_FORWARD_FUNC(fma)
+SWIZZLE_FORWARD_FUNC(frexp)
+SWIZZLE_FORWARD_FUNC(ldexp)
 SWIZZLE_FORWARD_FUNC(reflect)
+SWIZZLE_FORWARD_FUNC(refract)
+SWIZZLE_FORWARD_FUNC(packUnorm2x16)
+SWIZZLE_FORWARD_FUNC(packSnorm2x16)
+SWIZZLE_FORWARD_FUNC(packUnorm4x8)
+SWIZZLE_FORWARD_FUNC(packSnorm4x8)
+SWIZZLE_FORWARD_FUNC(unpackUnorm2x16)
+SWIZZLE_FORWARD_FUNC(unpackSnorm2x16)
+SWIZZLE_FORWARD_FUNC(unpackUnorm4x8)
+SWIZZLE_FORWARD_FUNC(unpackSnorm4x8)
+SWIZZLE_FORWARD_FUNC(packHalf2x16)
+SWIZZLE_FORWARD_FUNC(unpackHalf2x16)
 SWIZZLE_FORWARD_FUNC(length)
 SWIZZLE_FORWARD_FUNC(distance)
 SWIZZLE_FORWARD_FUNC(dot)
@@ -0,0 +1,349 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+// Renders frames of the sandbox shader at fixed times, with no window (and no SDL), to image files or
+// to a raw RGB stream, e.g. for ffmpeg:
+//   render_simd -s 1280x720 -t 0:10 -n 250 -o - | ffmpeg -f rawvideo -pix_fmt rgb24 -s 1280x720 -r 25 -i - out.mp4
+// Shading and output are pipelined: while frame N is encoded and written on writer threads, all the
+// OpenMP threads are already shading frame N+1.
+
+// ahead of the sandbox, so that shaders' macros can not get in the way
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <swizzle/glsl/bounded_queue.h>
+
+#include "sandbox.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+    struct options
+    {
+        int width;
+        int height;
+        double start;
+        double end;
+        int frames;
+        int writers;
+        std::string output;
+        bool quiet;
+    };
+
+    //! A shaded frame on its way to the writers.
+    struct job
+    {
+        size_t buffer;
+        int frame;
+    };
+
+    void printUsage()
+    {
+        std::cerr << "usage: render [-s WIDTHxHEIGHT] [-t START:END] [-n FRAMES] [-w WRITERS] [-q] -o OUTPUT\n";
+        std::cerr << "  -s  resolution, 640x360 by default\n";
+        std::cerr << "  -t  time of the first and the last frame, in seconds; 0:0 by default\n";
+        std::cerr << "  -n  frame count, 1 by default; frames are evenly spaced in time\n";
+        std::cerr << "  -w  threads encoding and writing image files while the next frames are shaded, 1 by\n";
+        std::cerr << "      default; a raw stream is always written by one, in order\n";
+        std::cerr << "  -q  no progress\n";
+        std::cerr << "  -o  a path with a printf-like frame number (e.g. frames/%04d.png), ending in .png, .tga,\n";
+        std::cerr << "      .ppm or .pfm; a single .rgb file, or - for stdout, gets all frames as raw 24 bit RGB,\n";
+        std::cerr << "      rows top-down\n";
+    }
+
+    bool parseOptions(int argc, char* argv[], options& result)
+    {
+        result.width = 640;
+        result.height = 360;
+        result.start = result.end = 0;
+        result.frames = 1;
+        result.writers = 1;
+        result.quiet = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            if (!std::strcmp(arg, "-q"))
+            {
+                result.quiet = true;
+                continue;
+            }
+
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            char tail;
+            if (!value)
+            {
+                return false;
+            }
+            else if (!std::strcmp(arg, "-s"))
+            {
+                if (std::sscanf(value, "%dx%d%c", &result.width, &result.height, &tail) != 2)
+                {
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "-t"))
+            {
+                if (std::sscanf(value, "%lf:%lf%c", &result.start, &result.end, &tail) != 2)
+                {
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "-n"))
+            {
+                if (std::sscanf(value, "%d%c", &result.frames, &tail) != 1)
+                {
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "-w"))
+            {
+                if (std::sscanf(value, "%d%c", &result.writers, &tail) != 1)
+                {
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "-o"))
+            {
+                result.output = value;
+            }
+            else
+            {
+                return false;
+            }
+            ++i;
+        }
+
+        return !result.output.empty() && result.frames > 0 && result.writers > 0 && result.writers <= 64 && result.width > 0 && result.height > 0 &&
+            swizzle::detail::image_io::valid_size(static_cast<std::uint64_t>(result.width), static_cast<std::uint64_t>(result.height));
+    }
+
+    bool isRawOutput(const std::string& output)
+    {
+        const size_t dot = output.rfind('.');
+        return output == "-" || (dot != std::string::npos && output.substr(dot) == ".rgb");
+    }
+
+    //! Replaces the first %d (with optional zero padding and width, e.g. %04d) of the pattern; %% is a
+    //! percent sign. Anything else is an error, so that the pattern never reaches printf.
+    bool framePath(const std::string& pattern, int frame, std::string& result)
+    {
+        result.clear();
+        bool replaced = false;
+        for (size_t i = 0; i < pattern.size(); ++i)
+        {
+            if (pattern[i] != '%')
+            {
+                result += pattern[i];
+                continue;
+            }
+            if (i + 1 < pattern.size() && pattern[i + 1] == '%')
+            {
+                result += '%';
+                ++i;
+                continue;
+            }
+
+            size_t j = i + 1;
+            const bool zeros = j < pattern.size() && pattern[j] == '0';
+            size_t width = 0;
+            for (; j < pattern.size() && pattern[j] >= '0' && pattern[j] <= '9'; ++j)
+            {
+                width = width * 10 + (pattern[j] - '0');
+            }
+            if (replaced || j >= pattern.size() || pattern[j] != 'd' || width > 16)
+            {
+                return false;
+            }
+
+            std::string number = std::to_string(frame);
+            if (number.size() < width)
+            {
+                number.insert(0, width - number.size(), zeros ? '0' : ' ');
+            }
+            result += number;
+            replaced = true;
+            i = j;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace std;
+    namespace image_io = swizzle::glsl::image_io;
+
+    options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        printUsage();
+        return 1;
+    }
+
+    const bool raw = isRawOutput(opts.output);
+    ofstream rawFile;
+    ostream* rawStream = nullptr;
+    if (raw)
+    {
+        if (opts.output == "-")
+        {
+#if defined(_WIN32)
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            rawStream = &cout;
+        }
+        else
+        {
+            rawFile.open(opts.output.c_str(), ios::binary);
+            rawStream = &rawFile;
+        }
+        if (!*rawStream)
+        {
+            cerr << "ERROR: unable to open " << opts.output << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        std::string first, last;
+        if (!framePath(opts.output, 0, first) || !framePath(opts.output, 1, last))
+        {
+            cerr << "ERROR: invalid output pattern: " << opts.output << "\n";
+            return 1;
+        }
+        if (opts.frames > 1 && first == last)
+        {
+            cerr << "ERROR: output pattern needs a frame number (%d) for more than one frame\n";
+            return 1;
+        }
+        if (image_io::format_from_path(first.c_str()) == image_io::format_unknown)
+        {
+            cerr << "ERROR: unknown image format: " << first << "\n";
+            return 1;
+        }
+    }
+
+    // files can be written in any order, a stream can not
+    const size_t writerCount = raw ? 1 : static_cast<size_t>(opts.writers);
+
+    // every writer busy with a frame, one more waiting for them and one being shaded; shading stalls
+    // only once all of these are taken
+    const int pitch = opts.width * 3;
+    std::vector<std::vector<uint8_t>> buffers(writerCount + 2, std::vector<uint8_t>(static_cast<size_t>(pitch) * opts.height));
+    swizzle::glsl::bounded_queue<size_t> freeBuffers(buffers.size());
+    swizzle::glsl::bounded_queue<job> shaded(buffers.size());
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        freeBuffers.push(i);
+    }
+
+    // the first failure stops shading; frames already shaded are still let through
+    std::atomic<bool> failed(false);
+    std::mutex errorMutex;
+    std::string error;
+
+    std::vector<std::thread> writers;
+    for (size_t i = 0; i < writerCount; ++i)
+    {
+        writers.emplace_back([&]()
+        {
+            job j;
+            while (shaded.pop(j))
+            {
+                const std::vector<uint8_t>& pixels = buffers[j.buffer];
+                std::string path;
+                bool written;
+                if (failed)
+                {
+                    written = true;
+                }
+                else if (raw)
+                {
+                    rawStream->write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+                    written = !rawStream->fail();
+                    path = opts.output;
+                }
+                else
+                {
+                    const image_io::image_view<const uint8_t> view = { pixels.data(), static_cast<size_t>(opts.width), static_cast<size_t>(opts.height), pitch, 3, { 0, 1, 2, -1 } };
+                    framePath(opts.output, j.frame, path);
+                    ofstream file(path.c_str(), ios::binary);
+                    written = image_io::write(file, image_io::format_from_path(path.c_str()), view);
+                }
+
+                if (!written && !failed.exchange(true))
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    error = "failed to write frame " + std::to_string(j.frame) + " to " + path;
+                }
+                freeBuffers.push(j.buffer);
+            }
+        });
+    }
+
+    glsl_sandbox::resolution.x = static_cast<float>(opts.width);
+    glsl_sandbox::resolution.y = static_cast<float>(opts.height);
+
+    const auto start = std::chrono::steady_clock::now();
+    tile_scheduler scheduler;
+    int frame = 0;
+    for (; frame < opts.frames && !failed; ++frame)
+    {
+        size_t buffer;
+        if (!freeBuffers.pop(buffer))
+        {
+            break;
+        }
+
+        // fixed times, so that renders are repeatable
+        const double t = opts.frames > 1 ? opts.start + (opts.end - opts.start) * frame / (opts.frames - 1) : opts.start;
+        glsl_sandbox::time = static_cast<float>(t);
+        glsl_sandbox::iFrame = frame;
+
+        renderFrame(scheduler, buffers[buffer].data(), opts.width, opts.height, pitch, swizzle::glsl::pixel_rgb24, []() { return false; });
+
+        const job j = { buffer, frame };
+        shaded.push(j);
+
+        if (!opts.quiet)
+        {
+            cerr << "frame " << (frame + 1) << "/" << opts.frames << "\t time: " << t << "\t shaded in " << scheduler.seconds() * 1000 << " ms\t balance: " << static_cast<int>(scheduler.balance() * 100) << "%     \r";
+        }
+    }
+
+    // let the writers finish what has been shaded
+    shaded.close();
+    for (auto& w : writers)
+    {
+        w.join();
+    }
+
+    if (raw)
+    {
+        rawStream->flush();
+        if (rawStream->fail() && !failed.exchange(true))
+        {
+            error = "failed to write to " + opts.output;
+        }
+    }
+    if (failed)
+    {
+        cerr << "\nERROR: " << error << "\n";
+        return 1;
+    }
+    if (!opts.quiet)
+    {
+        cerr << "\n" << frame << " frames in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+    }
+    return 0;
+}
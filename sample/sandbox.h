@@ -0,0 +1,388 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#pragma once
+
+// The sandbox shaders run in, shared by the interactive sample and the offline renderer: types,
+// uniforms, the shader itself and a function rendering a frame with it. Defines globals, so it is
+// included by a single translation unit of each executable.
+
+#if defined(USE_SIMD)
+#include "use_simd.h"
+#else
+#include "use_scalar.h"
+#endif
+
+#include <swizzle/glsl/vector.h>
+#include <swizzle/glsl/matrix.h>
+#include <swizzle/glsl/texture_functions.h>
+#include <swizzle/glsl/texture_sampler.h>
+#include <swizzle/glsl/random.h>
+#include <swizzle/glsl/tile_scheduler.h>
+#include <swizzle/glsl/pixel_packing.h>
+
+typedef swizzle::glsl::vector< float_type, 2 > vec2;
+typedef swizzle::glsl::vector< float_type, 3 > vec3;
+typedef swizzle::glsl::vector< float_type, 4 > vec4;
+
+static_assert(sizeof(vec2) == sizeof(float_type[2]), "Too big");
+static_assert(sizeof(vec3) == sizeof(float_type[3]), "Too big");
+static_assert(sizeof(vec4) == sizeof(float_type[4]), "Too big");
+
+typedef swizzle::glsl::matrix< swizzle::glsl::vector, vec4::scalar_type, 2, 2> mat2;
+typedef swizzle::glsl::matrix< swizzle::glsl::vector, vec4::scalar_type, 3, 3> mat3;
+typedef swizzle::glsl::matrix< swizzle::glsl::vector, vec4::scalar_type, 4, 4> mat4;
+
+// shaders tend to #define short names, so anything used after them better be named here
+typedef swizzle::glsl::tile_scheduler tile_scheduler;
+typedef tile_scheduler::tile screen_tile;
+typedef swizzle::glsl::pixel_format pixel_format;
+
+
+//! Maps a texture converted earlier (path + ".tex") or, the first time, loads the image (with the built-in
+//! decoders or SDL_image, for formats they lack) and saves it converted, then maps that. The image's size
+//! and modification time are kept next to the converted file (path + ".tex.src"); once they change, the
+//! image is converted again. A converted file without its image is used as is. Both files are replaced by a
+//! rename, never rewritten, so renders running alongside keep what they have mapped. Textures that fail to
+//! load become checkers.
+class sampler2D : public swizzle::glsl::sampler2D<float_type>
+{
+public:
+    enum WrapMode
+    {
+        Clamp = wrap_clamp,
+        Repeat = wrap_repeat,
+        MirrorRepeat = wrap_mirror_repeat
+    };
+
+    sampler2D(const char* path, WrapMode wrapMode);
+};
+
+// this where the magic happens...
+namespace glsl_sandbox
+{
+    // a nested namespace used when redefining 'inout' and 'out' keywords
+    namespace ref
+    {
+#ifdef CXXSWIZZLE_VECTOR_INOUT_WRAPPER_ENABLED
+        typedef swizzle::detail::vector_inout_wrapper<vec2> vec2;
+        typedef swizzle::detail::vector_inout_wrapper<vec3> vec3;
+        typedef swizzle::detail::vector_inout_wrapper<vec4> vec4;
+#else
+        typedef vec2& vec2;
+        typedef vec3& vec3;
+        typedef vec4& vec4;
+#endif
+        typedef ::float_type& float_type;
+    }
+
+    namespace in
+    {
+        typedef const ::vec2& vec2;
+        typedef const ::vec3& vec3;
+        typedef const ::vec4& vec4;
+        typedef const ::float_type& float_type;
+    }
+
+    #include <swizzle/glsl/vector_functions.h>
+
+    // constants shaders are using
+    float_type time = 1;
+    vec2 mouse(0, 0);
+    vec2 resolution;
+
+    // constants some shaders from shader toy are using
+    vec2& iResolution = resolution;
+    float_type& iGlobalTime = time;
+    vec2& iMouse = mouse;
+    int iFrame = 0;
+
+    // per-lane random numbers for Monte Carlo shaders; seed with rng(gl_FragCoord, iFrame)
+    typedef swizzle::glsl::random_generator<::float_type> rng;
+
+    sampler2D diffuse("diffuse.png", sampler2D::Repeat);
+    sampler2D specular("specular.png", sampler2D::Repeat);
+
+    struct fragment_shader
+    {
+        vec2 gl_FragCoord;
+        vec4 gl_FragColor;
+        void operator()(void);
+    };
+
+    // change meaning of glsl keywords to match sandbox
+    #define uniform extern
+    #define in in::
+    #define out ref::
+    #define inout ref::
+    #define main fragment_shader::operator()
+    #define float float_type   
+    #define bool bool_type
+    
+    #pragma warning(push)
+    #pragma warning(disable: 4244) // disable return implicit conversion warning
+    #pragma warning(disable: 4305) // disable truncation warning
+    
+    // pick one here or with -DSAMPLE_SHADER='"shaders/...frag"' (CMake: SAMPLE_SHADER)
+#ifdef SAMPLE_SHADER
+    #include SAMPLE_SHADER
+#else
+    //#include "shaders/sampler.frag"
+    //#include "shaders/leadlight.frag"
+    //#include "shaders/terrain.frag"
+    //#include "shaders/complex.frag"
+    //#include "shaders/road.frag"
+    //#include "shaders/gears.frag"
+    //#include "shaders/water_turbulence.frag"
+    #include "shaders/sky.frag"
+#endif
+
+    // be a dear a clean up
+    #pragma warning(pop)
+    #undef bool
+    #undef float
+    #undef main
+    #undef in
+    #undef out
+    #undef inout
+    #undef uniform
+}
+
+// these headers, especially SDL.h & time.h set up names that are in conflict with sandbox'es;
+// including them *after* sandbox solves it
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <swizzle/glsl/image_io.h>
+#include <swizzle/glsl/texture_store.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef SDLIMAGE_FOUND
+#include <SDL_image.h>
+#endif
+
+#if OMP_ENABLED
+#include <omp.h>
+#endif
+
+template <size_t Align, typename T>
+T* alignPtr(T* ptr)
+{
+    static_assert((Align & (Align - 1)) == 0, "Align needs to be a power of two");
+    auto value = reinterpret_cast<ptrdiff_t>(ptr);
+    return reinterpret_cast<T*>((value + Align) & (~(Align - 1)));
+}
+
+//! 0, 1, 2... for the first live lanes; the rest repeat the last live one.
+inline raw_float_type laneOffsets(size_t live)
+{
+    using ::swizzle::detail::static_for;
+
+    // well... this calls for an explanation: why not std::aligned_storage?
+    // turns out there's a thing like max_align_t that defines max possible
+    // align; SSE/AVX data has greater align than max_align_t on compilers
+    // I checked, so std::aligned_storage is useless here.
+    uint8_t unalignedBlob[scalar_count * sizeof(float) + float_entries_align];
+    float* aligned = alignPtr<float_entries_align>(reinterpret_cast<float*>(unalignedBlob));
+    static_for<0, scalar_count>([&](size_t i) { aligned[i] = static_cast<float>(i < live ? i : live - 1); });
+
+    raw_float_type result;
+    load_aligned(result, aligned);
+    return result;
+}
+
+//! Runs the shader for every pixel of a frame, on all threads, and stores the result in the given
+//! format, rows top-down and pitch bytes apart. Uniforms need to be set beforehand.
+//! Stops between tiles, returning false, once cancelled() returns true.
+template <class Cancelled>
+bool renderFrame(tile_scheduler& scheduler, uint8_t* pixels, int width, int height, int pitch, pixel_format format, Cancelled cancelled)
+{
+    const raw_float_type offsets = laneOffsets(scalar_count);
+    const size_t pixelSize = swizzle::glsl::pixel_size(format);
+
+    return scheduler.run(width, height, [&](const screen_tile& area, size_t)
+    {
+        // a tile's width needs not be a multiple of scalar_count; the last block of each row is then
+        // masked: its dead lanes shade the last live pixel again, so that they neither read past the
+        // tile's edge nor diverge from the live ones, and are never stored
+        const size_t tailLanes = area.width % scalar_count;
+        const raw_float_type tailOffsets = laneOffsets(tailLanes ? tailLanes : scalar_count);
+        const int endX = static_cast<int>(area.x + area.width);
+        const int endY = static_cast<int>(area.y + area.height);
+        const int tailX = endX - static_cast<int>(tailLanes);
+
+        // a row of the tile in packUnorm4x8 layout, dead lanes included, packed into the target in one go
+        std::vector<unsigned> rowColors(area.width + scalar_count - 1);
+
+        glsl_sandbox::fragment_shader shader;
+
+        for (int y = static_cast<int>(area.y); y < endY; ++y)
+        {
+            shader.gl_FragCoord.y = static_cast<float>(height - 1 - y);
+
+            for (int x = static_cast<int>(area.x); x < endX; x += scalar_count)
+            {
+                shader.gl_FragCoord.x = static_cast<float>(x) + (x < tailX ? offsets : tailOffsets);
+                
+                // vvvvvvvvvvvvvvvvvvvvvvvvvv
+                // THE SHADER IS INVOKED HERE
+                // ^^^^^^^^^^^^^^^^^^^^^^^^^^
+                shader();
+
+                // convert to RGBA8 in one go; packing clamps & rounds
+                store_unaligned(static_cast<uint_type>(glsl_sandbox::packUnorm4x8(shader.gl_FragColor)), rowColors.data() + (x - area.x));
+            }
+
+            // live pixels only, swizzled and interleaved with wide stores
+            swizzle::glsl::pack_pixels(rowColors.data(), area.width, format, pixels + y * pitch + area.x * pixelSize);
+        }
+    },
+    cancelled);
+}
+
+
+//! Size and modification time of a file, empty if there is no such file.
+inline std::string sourceStamp(const char* path)
+{
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        return std::string();
+    }
+    return std::to_string(static_cast<long long>(info.st_size)) + " " + std::to_string(static_cast<long long>(info.st_mtime));
+}
+
+sampler2D::sampler2D( const char* path, WrapMode wrapMode ) 
+    : swizzle::glsl::sampler2D<float_type>(static_cast<wrap_mode>(wrapMode))
+{
+    // mapping is instant and pages are only read once sampled
+    const std::string converted = std::string(path) + ".tex";
+    const std::string stampPath = converted + ".src";
+    const std::string stamp = sourceStamp(path);
+    std::string savedStamp;
+    {
+        std::ifstream file(stampPath.c_str());
+        std::getline(file, savedStamp);
+    }
+
+    auto& store = swizzle::glsl::texture_store::global();
+    if (!stamp.empty() && stamp != savedStamp && !sourceStamp(converted.c_str()).empty())
+    {
+        std::cerr << "NOTE: " << path << " has changed since it was converted, converting again\n";
+    }
+    else if (assign_mapped(store.open(converted.c_str())))
+    {
+        return;
+    }
+
+    // the built-in decoders first, SDL_image for whatever else it knows
+    namespace image_io = swizzle::glsl::image_io;
+    bool loaded = false;
+    bool supported = true;
+    std::string reason;
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            reason = "unable to open the file";
+        }
+        else
+        {
+            image_io::reader r(file);
+            std::vector<float> rgba;
+            if (r.read_rgba(rgba, true))
+            {
+                assign(r.width(), r.height(), std::move(rgba), default_layout, r.hdr() ? format_rgba16f : format_rgba8);
+                loaded = true;
+            }
+            else
+            {
+                // not recognised by the signature: left to SDL_image
+                supported = r.format() != image_io::format_unknown;
+                reason = r.error();
+            }
+        }
+    }
+
+    if (!loaded)
+    {
+#ifdef SDLIMAGE_FOUND
+        SDL_Surface* image = IMG_Load(path);
+        if (image)
+        {
+            // decode to RGBA8 once; SDL's rows go top-down, OpenGL's bottom-up
+            auto& format = *image->format;
+            std::vector<uint32_t> texels(image->w * image->h);
+            SDL_LockSurface(image);
+            for (int y = 0; y < image->h; ++y)
+            {
+                auto row = static_cast<const uint8_t*>(image->pixels) + (image->h - 1 - y) * image->pitch;
+                for (int x = 0; x < image->w; ++x)
+                {
+                    auto pixelPtr = row + x * format.BytesPerPixel;
+
+                    uint32_t pixel = 0;
+                    for (size_t i = 0; i < format.BytesPerPixel; ++i)
+                    {
+                        pixel |= (pixelPtr[i] << (i * 8));
+                    }
+
+                    uint32_t r = (pixel & format.Rmask) >> format.Rshift;
+                    uint32_t g = (pixel & format.Gmask) >> format.Gshift;
+                    uint32_t b = (pixel & format.Bmask) >> format.Bshift;
+                    uint32_t a = format.Amask ? ((pixel & format.Amask) >> format.Ashift) : 255;
+                    texels[y * image->w + x] = r | (g << 8) | (b << 16) | (a << 24);
+                }
+            }
+            SDL_UnlockSurface(image);
+
+            assign(image->w, image->h, texels.data());
+            SDL_FreeSurface(image);
+            loaded = true;
+        }
+        else
+        {
+            std::cerr << "WARNING: Failed to load texture " << path << "\n";
+            if (supported)
+            {
+                std::cerr << "  " << reason << "\n";
+            }
+            std::cerr << "  SDL_Image message: " << IMG_GetError() << "\n";
+        }
+#else
+        if (supported)
+        {
+            std::cerr << "WARNING: Failed to load texture " << path << ": " << reason << "\n";
+        }
+        else
+        {
+            std::cerr << "WARNING: Texture " << path << " won't be loaded, its format is not supported without SDL_image.\n";
+        }
+#endif
+
+        if (!loaded)
+        {
+            // checkers
+            const uint32_t checkers[] = { 0xff00ff00, 0xff0000ff, 0xff0000ff, 0xff00ff00 };
+            assign(2, 2, checkers);
+            filter(filter_nearest);
+            return;
+        }
+    }
+
+    // mapped right away, so that this run stays within the store's budget too
+    const swizzle::glsl::sampler2D<float_type> decoded = *this;
+    if (!save(converted.c_str()) || !assign_mapped(store.open(converted.c_str())))
+    {
+        std::cerr << "WARNING: Failed to save converted texture " << converted << ", keeping it in memory\n";
+        swizzle::glsl::sampler2D<float_type>::operator=(decoded);
+    }
+    else if (!stamp.empty())
+    {
+        swizzle::detail::replace_file(stampPath.c_str(), [&](std::ostream& file) { file << stamp << "\n"; });
+    }
+}
\ No newline at end of file
@@ -23,6 +23,12 @@ inline void store_aligned(T&& value, typename std::remove_reference<T>::type* ta
     *target = std::forward<T>(value);
 }
 
+template <typename T>
+inline void store_unaligned(T&& value, typename std::remove_reference<T>::type* target)
+{
+    *target = std::forward<T>(value);
+}
+
 template <typename T>
 inline void load_aligned(T& value, const T* data)
 {
@@ -2,6 +2,10 @@
 // Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
 #pragma once
 
+// uncomment this to get a warning for every function that has no SIMD implementation
+// and falls back to per-lane scalar calls
+// #define CXXSWIZZLE_LANE_MAP_REPORT
+
 // VC need to come first or else VC is going to complain.
 #include <Vc/vector.h>
 #include <swizzle/glsl/simd_support_vc.h>
@@ -29,6 +33,12 @@ inline void store_aligned(const Vc::Vector<T>& value, T* target)
     value.store(target, Vc::Aligned);
 }
 
+template <typename T>
+inline void store_unaligned(const Vc::Vector<T>& value, T* target)
+{
+    value.store(target, Vc::Unaligned);
+}
+
 template <typename T>
 inline void load_aligned(Vc::Vector<T>& value, const T* data)
 {
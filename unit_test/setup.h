@@ -2,10 +2,11 @@
 // Copyright (c) 2013, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
 #pragma once
 
+// scalar support needs to come first, so that the functions it adds are visible to vector's templates
+#include <swizzle/glsl/scalar_support.h>
 #include <swizzle/glsl/vector.h>
 #include <swizzle/glsl/matrix.h>
 #include <swizzle/glsl/vector_functions.h>
-#include <swizzle/glsl/scalar_support.h>
 
 typedef swizzle::glsl::vector< float, 1 > vec1;
 typedef swizzle::glsl::vector< float, 2 > vec2;
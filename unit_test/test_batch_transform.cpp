@@ -0,0 +1,99 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+#include <swizzle/glsl/batch_transform.h>
+#include <vector>
+
+namespace
+{
+    const mat4 transform(
+        2, 0, 1, 0,
+        0.5f, 3, 0, 0,
+        0, 1, -1, 0,
+        4, 5, 6, 1);
+
+    // more than the threshold, so that the parallel & streaming path gets hit, and not a multiple of 4
+    const size_t large_count = CXXSWIZZLE_BATCH_LARGE_THRESHOLD + 3;
+
+    inline bool are_vectors_close(const vec4& a, const vec4& b)
+    {
+        return distance(a, b) < 1e-4f;
+    }
+
+    template <size_t Size>
+    std::vector< swizzle::glsl::vector<float, Size> > make_input(size_t count)
+    {
+        std::vector< swizzle::glsl::vector<float, Size> > result(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t c = 0; c < Size; ++c)
+            {
+                result[i][c] = static_cast<float>((i * 7 + c * 3) % 17) - 8.0f;
+            }
+        }
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(BatchTransform)
+
+BOOST_AUTO_TEST_CASE(aos)
+{
+    for (size_t count : { size_t(0), size_t(1), size_t(7), large_count })
+    {
+        auto in3 = make_input<3>(count);
+        auto in4 = make_input<4>(count);
+        std::vector<vec3> points3(count), directions3(count), normals(count);
+        std::vector<vec4> points4(count), directions4(count);
+
+        swizzle::glsl::transform_points(transform, in3.data(), points3.data(), count);
+        swizzle::glsl::transform_points(transform, in4.data(), points4.data(), count);
+        swizzle::glsl::transform_directions(transform, in3.data(), directions3.data(), count);
+        swizzle::glsl::transform_directions(transform, in4.data(), directions4.data(), count);
+        swizzle::glsl::transform_normals(transform, in3.data(), normals.data(), count);
+
+        mat3 normalMatrix = transpose(inverse(mat3(transform)));
+        for (size_t i = 0; i < count; ++i)
+        {
+            BOOST_REQUIRE( are_vectors_close(vec4(points3[i], 0), vec4((transform * vec4(in3[i], 1)).xyz, 0)) );
+            BOOST_REQUIRE( are_vectors_close(points4[i], transform * in4[i]) );
+            BOOST_REQUIRE( are_vectors_close(vec4(directions3[i], 0), vec4((transform * vec4(in3[i], 0)).xyz, 0)) );
+            BOOST_REQUIRE( are_vectors_close(directions4[i], transform * vec4(in4[i].xyz, 0)) );
+            BOOST_REQUIRE( are_vectors_close(vec4(normals[i], 0), vec4(normalMatrix * in3[i], 0)) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(soa)
+{
+    const size_t count = large_count;
+    auto in = make_input<3>(count);
+
+    std::vector<float> x(count), y(count), z(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        x[i] = in[i].x;
+        y[i] = in[i].y;
+        z[i] = in[i].z;
+    }
+
+    std::vector<float> ox(count), oy(count), oz(count);
+    swizzle::glsl::soa3_span<const float> src = { x.data(), y.data(), z.data() };
+    swizzle::glsl::soa3_span<float> dst = { ox.data(), oy.data(), oz.data() };
+
+    swizzle::glsl::transform_points(transform, src, dst, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        BOOST_REQUIRE( are_vectors_close(vec4(ox[i], oy[i], oz[i], 1), transform * vec4(in[i], 1)) );
+    }
+
+    swizzle::glsl::transform_directions(transform, src, dst, 5);
+    for (size_t i = 0; i < 5; ++i)
+    {
+        BOOST_REQUIRE( are_vectors_close(vec4(ox[i], oy[i], oz[i], 0), transform * vec4(in[i], 0)) );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,72 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include <swizzle/glsl/bounded_queue.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using swizzle::glsl::bounded_queue;
+
+BOOST_AUTO_TEST_SUITE(BoundedQueue)
+
+BOOST_AUTO_TEST_CASE(fifo)
+{
+    bounded_queue<int> queue(3);
+    BOOST_CHECK( queue.push(1) );
+    BOOST_CHECK( queue.push(2) );
+
+    int value = 0;
+    BOOST_CHECK( queue.pop(value) );
+    BOOST_CHECK_EQUAL( value, 1 );
+
+    // what is left is drained after closing, and nothing gets in
+    queue.close();
+    BOOST_CHECK( !queue.push(3) );
+    BOOST_CHECK( queue.pop(value) );
+    BOOST_CHECK_EQUAL( value, 2 );
+    BOOST_CHECK( !queue.pop(value) );
+}
+
+BOOST_AUTO_TEST_CASE(pipeline)
+{
+    const int count = 10000;
+    const size_t capacity = 4, consumer_count = 3;
+    bounded_queue<int> queue(capacity);
+
+    // no Boost.Test on the consumers' threads
+    std::atomic<int> sum(0), popped(0);
+    std::atomic<size_t> overfull(0);
+    std::vector<std::thread> consumers;
+    for (size_t i = 0; i < consumer_count; ++i)
+    {
+        consumers.emplace_back([&]()
+        {
+            int value;
+            while (queue.pop(value))
+            {
+                sum += value;
+                // the producer is at most capacity items ahead, give or take the ones other consumers
+                // have popped but not counted yet
+                overfull += static_cast<size_t>(value) > static_cast<size_t>(popped.fetch_add(1)) + capacity + consumer_count;
+            }
+        });
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        BOOST_REQUIRE( queue.push(i) );
+    }
+    queue.close();
+    for (auto& c : consumers)
+    {
+        c.join();
+    }
+
+    BOOST_CHECK_EQUAL( popped.load(), count );
+    BOOST_CHECK_EQUAL( sum.load(), count * (count - 1) / 2 );
+    BOOST_CHECK_EQUAL( overfull.load(), 0u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
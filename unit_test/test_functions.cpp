@@ -0,0 +1,98 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include <limits>
+#include "setup.h"
+
+BOOST_AUTO_TEST_SUITE(Functions)
+
+BOOST_AUTO_TEST_CASE(rounding)
+{
+    vec4 v(-1.5f, -0.5f, 0.5f, 2.5f);
+
+    BOOST_CHECK( trunc(v) == vec4(-1, 0, 0, 2) );
+    BOOST_CHECK( round(v) == vec4(-2, -1, 1, 3) );
+    BOOST_CHECK( roundEven(v) == vec4(-2, 0, 0, 2) );
+    BOOST_CHECK( trunc(2.75f) == 2.0f );
+    BOOST_CHECK( roundEven(3.5f) == 4.0f );
+}
+
+BOOST_AUTO_TEST_CASE(modf_frexp_ldexp)
+{
+    vec3 integral;
+    vec3 fraction = modf(vec3(1.25f, -2.5f, 3.0f), integral);
+    BOOST_CHECK( integral == vec3(1, -2, 3) );
+    BOOST_CHECK( fraction == vec3(0.25f, -0.5f, 0.0f) );
+
+    float i;
+    BOOST_CHECK( modf(4.75f, i) == 0.75f && i == 4.0f );
+
+    ivec3 exp;
+    vec3 mantissa = frexp(vec3(1, 8, 0.75f), exp);
+    BOOST_CHECK( mantissa == vec3(0.5f, 0.5f, 0.75f) );
+    BOOST_CHECK( exp == ivec3(1, 4, 0) );
+    BOOST_CHECK( ldexp(mantissa, exp) == vec3(1, 8, 0.75f) );
+
+    int e;
+    BOOST_CHECK( frexp(12.0f, e) == 0.75f && e == 4 );
+}
+
+BOOST_AUTO_TEST_CASE(fma_isnan_isinf)
+{
+    BOOST_CHECK( fma(vec2(1, 2), vec2(3, 4), vec2(5, 6)) == vec2(8, 14) );
+
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    vec4 v(0, inf, -inf, nan);
+    BOOST_CHECK( isnan(v) == bvec4(false, false, false, true) );
+    BOOST_CHECK( isinf(v) == bvec4(false, true, true, false) );
+}
+
+BOOST_AUTO_TEST_CASE(refract_test)
+{
+    vec3 n(0, 1, 0);
+    vec3 i = normalize(vec3(1, -1, 0));
+
+    // eta == 1 does not bend the ray
+    vec3 r = refract(i, n, 1.0f);
+    BOOST_CHECK( are_close(r.x, i.x) && are_close(r.y, i.y) && r.z == 0 );
+
+    // total internal reflection
+    BOOST_CHECK( refract(i, n, 2.0f) == vec3(0) );
+}
+
+BOOST_AUTO_TEST_CASE(packing)
+{
+    BOOST_CHECK( packUnorm4x8(vec4(0, 1, 0.5f, 2)) == 0xff80ff00u );
+    BOOST_CHECK( packSnorm4x8(vec4(-1, 1, 0, -2)) == 0x81007f81u );
+    BOOST_CHECK( packUnorm2x16(vec2(1, 0)) == 0x0000ffffu );
+    BOOST_CHECK( packSnorm2x16(vec2(-1, 1)) == 0x7fff8001u );
+
+    BOOST_CHECK( unpackUnorm4x8(0xff00ff00u) == vec4(0, 1, 0, 1) );
+    BOOST_CHECK( unpackSnorm4x8(0x7f8180u) == vec4(-1, -1, 1, 0) );
+    BOOST_CHECK( unpackUnorm2x16(0xffff0000u) == vec2(0, 1) );
+    BOOST_CHECK( unpackSnorm2x16(0x80007fffu) == vec2(1, -1) );
+
+    vec4 v(0.25f, 0.5f, 0.75f, 1.0f);
+    BOOST_CHECK( packUnorm4x8(unpackUnorm4x8(packUnorm4x8(v))) == packUnorm4x8(v) );
+}
+
+BOOST_AUTO_TEST_CASE(half_packing)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+
+    BOOST_CHECK( packHalf2x16(vec2(1, -2)) == 0xc0003c00u );
+    BOOST_CHECK( packHalf2x16(vec2(65504.0f, 1e6f)) == 0x7c007bffu );
+    BOOST_CHECK( packHalf2x16(vec2(-inf, 0)) == 0x0000fc00u );
+    // smallest subnormal half
+    BOOST_CHECK( packHalf2x16(vec2(5.9604645e-8f, 0)) == 0x0001u );
+    // ties to even: 1 + 2^-11 rounds down, 1 + 3 * 2^-11 rounds up
+    BOOST_CHECK( packHalf2x16(vec2(1.00048828125f, 1.00146484375f)) == 0x3c023c00u );
+
+    BOOST_CHECK( unpackHalf2x16(0xc0003c00u) == vec2(1, -2) );
+    BOOST_CHECK( unpackHalf2x16(0x7c000001u) == vec2(5.9604645e-8f, inf) );
+    BOOST_CHECK( isnan(unpackHalf2x16(0x7e00u).x) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
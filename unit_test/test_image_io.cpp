@@ -0,0 +1,213 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+#include <swizzle/glsl/image_io.h>
+#include <swizzle/glsl/texture_sampler.h>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace image_io = swizzle::glsl::image_io;
+typedef swizzle::glsl::sampler2D<float> sampler2D;
+
+namespace
+{
+    //! 3x2, palette of 2 bit indices, Adam7 interlaced, the blue entry half transparent:
+    //! red, green, blue in the top row, white, blue, green in the bottom one.
+    const std::uint8_t palette_png[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+        0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02, 0x02, 0x03, 0x00, 0x00, 0x01, 0x97, 0x1d, 0xbe,
+        0x1f, 0x00, 0x00, 0x00, 0x0c, 0x50, 0x4c, 0x54, 0x45, 0xff, 0x00, 0x00, 0x00, 0xff, 0x00, 0x00,
+        0x00, 0xff, 0xff, 0xff, 0xff, 0xfb, 0x00, 0x60, 0xf6, 0x00, 0x00, 0x00, 0x03, 0x74, 0x52, 0x4e,
+        0x53, 0xff, 0xff, 0x80, 0x3a, 0x72, 0x8e, 0x61, 0x00, 0x00, 0x00, 0x10, 0x49, 0x44, 0x41, 0x54,
+        0x78, 0xda, 0x63, 0x60, 0x60, 0x68, 0x60, 0x70, 0x60, 0x78, 0x02, 0x00, 0x04, 0x2c, 0x01, 0xa5,
+        0x5f, 0x2d, 0x12, 0xde, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82
+    };
+
+    const std::uint32_t texels_2x2[] = { 0xff0000ff, 0xff00ff00, 0xffff0000, 0xffffffff };
+
+    const std::uint8_t palette_png_rgba[] = {
+        255, 0, 0, 255,     0, 255, 0, 255,     0, 0, 255, 128,
+        255, 255, 255, 255, 0, 0, 255, 128,     0, 255, 0, 255
+    };
+
+    std::string as_string(const std::uint8_t* data, size_t size)
+    {
+        return std::string(reinterpret_cast<const char*>(data), size);
+    }
+
+    //! Every channel of every pixel different.
+    std::vector<std::uint8_t> test_pattern(size_t width, size_t height)
+    {
+        std::vector<std::uint8_t> result(width * height * 4);
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            result[i] = static_cast<std::uint8_t>(i * 37 + (i >> 2) * 11);
+        }
+        return result;
+    }
+
+    //! Reads the whole file as top-down RGBA8; empty on failure.
+    std::vector<std::uint8_t> decode(const std::string& file, size_t width, size_t height)
+    {
+        std::istringstream in(file);
+        image_io::reader r(in);
+        std::vector<std::uint8_t> result(width * height * 4);
+        if (!r.valid() || r.width() != width || r.height() != height || !r.read(image_io::rgba_view(result.data(), width, height)))
+        {
+            result.clear();
+        }
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(ImageIO)
+
+BOOST_AUTO_TEST_CASE(formats_by_path)
+{
+    BOOST_CHECK( image_io::format_from_path("a/b.c/shot.png") == image_io::format_png );
+    BOOST_CHECK( image_io::format_from_path("SHOT.TGA") == image_io::format_tga );
+    BOOST_CHECK( image_io::format_from_path("shot.pgm") == image_io::format_ppm );
+    BOOST_CHECK( image_io::format_from_path("shot.pfm") == image_io::format_pfm );
+    BOOST_CHECK( image_io::format_from_path("shot.jpg") == image_io::format_unknown );
+    BOOST_CHECK( image_io::format_from_path("shot") == image_io::format_unknown );
+}
+
+BOOST_AUTO_TEST_CASE(round_trips)
+{
+    const size_t width = 7, height = 5;
+    const std::vector<std::uint8_t> pixels = test_pattern(width, height);
+    const auto view = image_io::rgba_view(pixels.data(), width, height);
+
+    const image_io::file_format formats[] = { image_io::format_ppm, image_io::format_pfm, image_io::format_tga, image_io::format_png };
+    for (auto format : formats)
+    {
+        std::ostringstream out;
+        BOOST_REQUIRE( image_io::write(out, format, view) );
+
+        const std::vector<std::uint8_t> decoded = decode(out.str(), width, height);
+        BOOST_REQUIRE( decoded.size() == pixels.size() );
+
+        // PPM and PFM have no alpha
+        const bool alpha = format == image_io::format_tga || format == image_io::format_png;
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL( decoded[i], (i % 4 == 3 && !alpha) ? 255 : pixels[i] );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(hdr)
+{
+    const float pixels[] = {
+        0.0f, 0.5f, 1.0f, 1.0f,     2.5f, 100.0f, -1.0f, 1.0f,
+        1e-3f, 3.0f, 0.25f, 1.0f,   65504.0f, 7.0f, 0.125f, 1.0f
+    };
+
+    std::ostringstream out;
+    BOOST_REQUIRE( image_io::write(out, image_io::format_pfm, image_io::rgba_view(pixels, 2, 2)) );
+
+    std::istringstream in(out.str());
+    image_io::reader r(in);
+    BOOST_REQUIRE( r.valid() );
+    BOOST_CHECK( r.hdr() );
+    BOOST_CHECK_EQUAL( r.channels(), 3u );
+
+    float decoded[16];
+    BOOST_REQUIRE( r.read(image_io::rgba_view(decoded, 2, 2)) );
+    for (size_t i = 0; i < 16; ++i)
+    {
+        BOOST_CHECK_EQUAL( decoded[i], pixels[i] );
+    }
+}
+
+BOOST_AUTO_TEST_CASE(strided_views)
+{
+    // a 24 bit BGR framebuffer, rows padded to 4 bytes, encoded in place
+    const size_t width = 5, height = 3, pitch = 16;
+    const std::vector<std::uint8_t> pixels = test_pattern(width, height);
+    std::vector<std::uint8_t> framebuffer(pitch * height, 0xcd);
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            const std::uint8_t* src = &pixels[(y * width + x) * 4];
+            std::uint8_t* dst = &framebuffer[y * pitch + x * 3];
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        }
+    }
+
+    const image_io::image_view<const std::uint8_t> view = { framebuffer.data(), width, height, pitch, 3, { 2, 1, 0, -1 } };
+    std::ostringstream out;
+    BOOST_REQUIRE( image_io::write(out, image_io::format_png, view) );
+
+    const std::vector<std::uint8_t> decoded = decode(out.str(), width, height);
+    BOOST_REQUIRE( decoded.size() == pixels.size() );
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( decoded[i], i % 4 == 3 ? 255 : pixels[i] );
+    }
+
+    // and decoded bottom-up, into floats
+    std::istringstream in(out.str());
+    std::vector<float> rgba;
+    BOOST_REQUIRE( image_io::reader(in).read_rgba(rgba, true) );
+    BOOST_REQUIRE_EQUAL( rgba.size(), pixels.size() );
+    BOOST_CHECK_CLOSE( rgba[0], pixels[(height - 1) * width * 4] / 255.0f, 1e-4f );
+}
+
+BOOST_AUTO_TEST_CASE(interlaced_palette)
+{
+    const std::vector<std::uint8_t> decoded = decode(as_string(palette_png, sizeof(palette_png)), 3, 2);
+    BOOST_REQUIRE_EQUAL( decoded.size(), sizeof(palette_png_rgba) );
+    for (size_t i = 0; i < decoded.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( decoded[i], palette_png_rgba[i] );
+    }
+}
+
+BOOST_AUTO_TEST_CASE(textures)
+{
+    std::istringstream in(as_string(palette_png, sizeof(palette_png)));
+    sampler2D s(sampler2D::wrap_clamp, sampler2D::filter_nearest);
+    BOOST_REQUIRE( image_io::read_texture(in, s) );
+
+    // rows are bottom-up, like OpenGL's
+    BOOST_CHECK( texelFetch(s, ivec2(0, 0), 0) == vec4(1, 1, 1, 1) );
+    BOOST_CHECK( texelFetch(s, ivec2(1, 0), 0) == vec4(0, 0, 1, 128 / 255.0f) );
+    BOOST_CHECK( texelFetch(s, ivec2(0, 1), 0) == vec4(1, 0, 0, 1) );
+    BOOST_CHECK( texelFetch(s, ivec2(2, 1), 0) == vec4(0, 0, 1, 128 / 255.0f) );
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    // not an image
+    {
+        std::istringstream in("P7 hello");
+        image_io::reader r(in);
+        BOOST_CHECK( !r.valid() );
+        BOOST_CHECK( std::string(r.error()) != "" );
+    }
+
+    // cut in the middle of the pixels
+    BOOST_CHECK( decode(as_string(palette_png, sizeof(palette_png) - 30), 3, 2).empty() );
+
+    // a flipped bit in the compressed pixels fails the chunk's checksum
+    std::string corrupted = as_string(palette_png, sizeof(palette_png));
+    corrupted[84] ^= 0x10;
+    BOOST_CHECK( decode(corrupted, 3, 2).empty() );
+
+    // a texture that can not be read is left alone
+    std::istringstream in("P6\n1 1\n255\n");
+    sampler2D s(sampler2D::wrap_clamp, sampler2D::filter_nearest);
+    s.assign(2, 2, texels_2x2);
+    BOOST_CHECK( !image_io::read_texture(in, s) );
+    BOOST_CHECK( texelFetch(s, ivec2(1, 1), 0) == vec4(1, 1, 1, 1) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+#include <swizzle/glsl/affine.h>
+
+typedef swizzle::glsl::affine3<swizzle::glsl::vector, float> affine3;
+
+BOOST_AUTO_TEST_SUITE(Matrix)
+
+BOOST_AUTO_TEST_CASE(matrix_vector_mul)
+{
+    // column major, as in GLSL
+    mat2 m2(1, 2, 3, 4);
+    BOOST_CHECK( m2 * vec2(5, 6) == vec2(23, 34) );
+    BOOST_CHECK( vec2(5, 6) * m2 == vec2(17, 39) );
+
+    mat3 m3(1, 2, 3, 4, 5, 6, 7, 8, 9);
+    BOOST_CHECK( m3 * vec3(1, 0, -1) == vec3(-6, -6, -6) );
+    BOOST_CHECK( vec3(1, 0, -1) * m3 == vec3(-2, -2, -2) );
+
+    mat4 m4(2.0f);
+    m4[3] = vec4(1, 2, 3, 1);
+    BOOST_CHECK( m4 * vec4(1, 1, 1, 1) == vec4(3, 4, 5, 1) );
+
+    // non-square: 3 rows, 2 columns
+    mat3x2 m32(1, 2, 3, 4, 5, 6);
+    BOOST_CHECK( m32 * vec2(1, 1) == vec3(5, 7, 9) );
+    BOOST_CHECK( vec3(1, 1, 1) * m32 == vec2(6, 15) );
+}
+
+BOOST_AUTO_TEST_CASE(matrix_matrix_mul)
+{
+    mat2 a(1, 2, 3, 4), b(5, 6, 7, 8);
+    BOOST_CHECK( a * b == mat2(23, 34, 31, 46) );
+    BOOST_CHECK( a * mat2(1) == a );
+
+    mat2 c = a;
+    c *= b;
+    BOOST_CHECK( c == a * b );
+
+    mat3 m3(1, 2, 3, 4, 5, 6, 7, 8, 10);
+    BOOST_CHECK( (m3 * m3) * vec3(1, 2, 3) == m3 * (m3 * vec3(1, 2, 3)) );
+}
+
+template <class TMatrix>
+bool are_matrices_close(const TMatrix& a, const TMatrix& b, float eps = 1e-5f)
+{
+    bool result = true;
+    for (size_t col = 0; col < TMatrix::m_dimension; ++col)
+    {
+        for (size_t row = 0; row < TMatrix::n_dimension; ++row)
+        {
+            result &= std::abs(a[col][row] - b[col][row]) <= eps;
+        }
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(transpose_outer_comp_mult)
+{
+    mat3x2 m(1, 2, 3, 4, 5, 6);
+    mat2x3 t = transpose(m);
+    BOOST_CHECK( t == mat2x3(1, 4, 2, 5, 3, 6) );
+    BOOST_CHECK( transpose(t) == m );
+
+    BOOST_CHECK( outerProduct(vec2(1, 2), vec3(3, 4, 5)) == mat2x3(3, 6, 4, 8, 5, 10) );
+    BOOST_CHECK( matrixCompMult(mat2(1, 2, 3, 4), mat2(5, 6, 7, 8)) == mat2(5, 12, 21, 32) );
+}
+
+BOOST_AUTO_TEST_CASE(determinant_inverse)
+{
+    mat2 m2(4, 7, 2, 6);
+    BOOST_CHECK( determinant(m2) == 10 );
+    BOOST_CHECK( are_matrices_close(inverse(m2) * m2, mat2(1)) );
+
+    mat3 m3(2, 0, 1, 1, 3, 2, 1, 1, 2);
+    BOOST_CHECK( determinant(m3) == 6 );
+    BOOST_CHECK( are_matrices_close(inverse(m3) * m3, mat3(1)) );
+    BOOST_CHECK( determinant(transpose(m3)) == determinant(m3) );
+
+    mat4 m4(1, 2, 0, 1,  0, 1, 3, 2,  2, 0, 1, 1,  1, 1, 1, 4);
+    BOOST_CHECK( determinant(m4) == 37 );
+    BOOST_CHECK( are_matrices_close(inverse(m4) * m4, mat4(1)) );
+    BOOST_CHECK( are_matrices_close(m4 * inverse(m4), mat4(1)) );
+    BOOST_CHECK( determinant(mat4(2)) == 16 );
+}
+
+BOOST_AUTO_TEST_CASE(affine)
+{
+    mat4 m(0, 1, 0, 0,  -1, 0, 0, 0,  0, 0, 2, 0,  1, 2, 3, 1);
+    affine3 a(m);
+
+    BOOST_CHECK( a.to_mat4() == m );
+    BOOST_CHECK( a.translation() == vec3(1, 2, 3) );
+    BOOST_CHECK( a.transform_point(vec3(1, 1, 1)) == (m * vec4(1, 1, 1, 1)).xyz );
+    BOOST_CHECK( a.transform_direction(vec3(1, 1, 1)) == (m * vec4(1, 1, 1, 0)).xyz );
+    BOOST_CHECK( a * vec4(1, 2, 3, 1) == m * vec4(1, 2, 3, 1) );
+
+    affine3 b(mat3(2), vec3(-1, 0, 1));
+    BOOST_CHECK( (a * b).to_mat4() == m * b.to_mat4() );
+    BOOST_CHECK( (a * affine3()) == a );
+
+    affine3 c = a;
+    c *= b;
+    BOOST_CHECK( c == a * b );
+
+    BOOST_CHECK( are_matrices_close(inverse(a).to_mat4(), inverse(m)) );
+    BOOST_CHECK( (inverse(a) * a) == affine3() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,57 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include <swizzle/glsl/pixel_packing.h>
+#include <cstdint>
+#include <vector>
+
+using namespace swizzle::glsl;
+
+BOOST_AUTO_TEST_SUITE(PixelPacking)
+
+BOOST_AUTO_TEST_CASE(formats)
+{
+    // enough for every SIMD block size and every remainder after it
+    const size_t max_count = 41;
+    std::vector<std::uint32_t> colors(max_count + 1);
+    for (size_t i = 0; i < colors.size(); ++i)
+    {
+        colors[i] = static_cast<std::uint32_t>(0x04030201u + i * 0x11223344u);
+    }
+
+    // source and target misaligned on purpose
+    const pixel_format formats[] = { pixel_rgb24, pixel_bgr24, pixel_rgba32, pixel_bgra32 };
+    for (auto format : formats)
+    {
+        const size_t size = pixel_size(format);
+        const bool bgr = format == pixel_bgr24 || format == pixel_bgra32;
+        for (size_t count = 0; count <= max_count; ++count)
+        {
+            std::vector<std::uint8_t> target(1 + count * size + 16, 0xcd);
+            pack_pixels(colors.data() + 1, count, format, target.data() + 1);
+
+            size_t wrong = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const std::uint32_t c = colors[i + 1];
+                const std::uint8_t* p = target.data() + 1 + i * size;
+                wrong += p[0] != static_cast<std::uint8_t>(bgr ? c >> 16 : c);
+                wrong += p[1] != static_cast<std::uint8_t>(c >> 8);
+                wrong += p[2] != static_cast<std::uint8_t>(bgr ? c : c >> 16);
+                wrong += size == 4 && p[3] != static_cast<std::uint8_t>(c >> 24);
+            }
+            BOOST_CHECK_EQUAL( wrong, 0u );
+
+            // nothing written around the pixels
+            size_t outside = target[0] != 0xcd;
+            for (size_t i = 1 + count * size; i < target.size(); ++i)
+            {
+                outside += target[i] != 0xcd;
+            }
+            BOOST_CHECK_EQUAL( outside, 0u );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
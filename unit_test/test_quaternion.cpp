@@ -0,0 +1,98 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+#include <swizzle/glsl/quaternion.h>
+
+typedef swizzle::glsl::quat<float> quat;
+
+namespace
+{
+    const float half_pi = 1.57079632679f;
+
+    inline bool are_vectors_close(const vec3& a, const vec3& b)
+    {
+        return distance(a, b) < 1e-5f;
+    }
+
+    //! q and -q are the same rotation
+    inline bool are_rotations_close(const quat& a, const quat& b)
+    {
+        return std::abs(std::abs(dot(a, b)) - 1.0f) < 1e-5f;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(Quaternion)
+
+BOOST_AUTO_TEST_CASE(swizzles)
+{
+    quat q(1, 2, 3, 4);
+    BOOST_CHECK( vec3(q.xyz) == vec3(1, 2, 3) );
+    BOOST_CHECK( q.w == 4 );
+    BOOST_CHECK( vec4(quat().wzyx) == vec4(1, 0, 0, 0) );
+    BOOST_CHECK( dot(q, q) == 30 );
+    BOOST_CHECK( length(normalize(q)) == 1 );
+}
+
+BOOST_AUTO_TEST_CASE(rotate_and_multiply)
+{
+    quat rz = quat::angle_axis(half_pi, vec3(0, 0, 1));
+    quat rx = quat::angle_axis(half_pi, vec3(1, 0, 0));
+
+    BOOST_CHECK( are_vectors_close(rotate(rz, vec3(1, 0, 0)), vec3(0, 1, 0)) );
+    BOOST_CHECK( are_vectors_close(rotate(rx, vec3(0, 1, 0)), vec3(0, 0, 1)) );
+
+    // composition applies the right-hand side first
+    vec3 v(1, 2, 3);
+    BOOST_CHECK( are_vectors_close(rotate(rx * rz, v), rotate(rx, rotate(rz, v))) );
+
+    quat q = rz;
+    q *= rx;
+    BOOST_CHECK( are_rotations_close(q, rz * rx) );
+
+    BOOST_CHECK( are_rotations_close(rz * inverse(rz), quat()) );
+    BOOST_CHECK( are_rotations_close(conjugate(rz), inverse(rz)) );
+    BOOST_CHECK( are_vectors_close(rotate(inverse(rz), rotate(rz, v)), v) );
+}
+
+BOOST_AUTO_TEST_CASE(matrix_conversion)
+{
+    vec3 v(1, -2, 0.5f);
+    vec3 axes[] = { vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1), normalize(vec3(1, 1, 0)), normalize(vec3(1, -1, 0)), normalize(vec3(-2, 3, 1)) };
+    float angles[] = { 0.0f, 0.3f, half_pi, 3.0f, 2 * half_pi, -2.5f };
+
+    // covers all four branches of the matrix-to-quaternion conversion, including 180 degrees rotations
+    for (const vec3& axis : axes)
+    {
+        for (float angle : angles)
+        {
+            quat q = quat::angle_axis(angle, axis);
+            mat3 m = q.to_mat3();
+            BOOST_CHECK( are_vectors_close(m * v, rotate(q, v)) );
+            BOOST_CHECK( are_rotations_close(quat(m), q) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(interpolation)
+{
+    quat a = quat::angle_axis(0.2f, vec3(0, 0, 1));
+    quat b = quat::angle_axis(1.4f, vec3(0, 0, 1));
+
+    BOOST_CHECK( are_rotations_close(slerp(a, b, 0.0f), a) );
+    BOOST_CHECK( are_rotations_close(slerp(a, b, 1.0f), b) );
+    BOOST_CHECK( are_rotations_close(slerp(a, b, 0.25f), quat::angle_axis(0.5f, vec3(0, 0, 1))) );
+    BOOST_CHECK( are_rotations_close(nlerp(a, b, 0.5f), quat::angle_axis(0.8f, vec3(0, 0, 1))) );
+
+    // -b is the same rotation; the shorter arc is taken regardless
+    quat nb(-vec4(b));
+    BOOST_CHECK( are_rotations_close(slerp(a, nb, 0.25f), quat::angle_axis(0.5f, vec3(0, 0, 1))) );
+    BOOST_CHECK( are_rotations_close(nlerp(a, nb, 0.5f), quat::angle_axis(0.8f, vec3(0, 0, 1))) );
+
+    // nearly identical ones take the linear path
+    BOOST_CHECK( are_rotations_close(slerp(a, a, 0.5f), a) );
+    BOOST_CHECK( std::abs(length(slerp(a, a, 0.5f)) - 1.0f) < 1e-5f );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,74 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+#include <swizzle/glsl/random.h>
+
+typedef swizzle::glsl::random_generator<float> rng;
+
+BOOST_AUTO_TEST_SUITE(Random)
+
+BOOST_AUTO_TEST_CASE(streams)
+{
+    rng a(vec2(10, 20), 0), b(vec2(10, 20), 0), c(vec2(11, 20), 0), d(vec2(10, 20), 1);
+
+    bool differentPixel = false, differentFrame = false;
+    for (int i = 0; i < 16; ++i)
+    {
+        unsigned x = a.next_uint();
+        BOOST_CHECK( x == b.next_uint() );
+        differentPixel |= x != c.next_uint();
+        differentFrame |= x != d.next_uint();
+    }
+    BOOST_CHECK( differentPixel );
+    BOOST_CHECK( differentFrame );
+}
+
+BOOST_AUTO_TEST_CASE(uniform)
+{
+    rng r(12345u);
+    const int count = 100000;
+    double sum = 0;
+    int buckets[10] = {};
+    for (int i = 0; i < count; ++i)
+    {
+        float f = r.next_float();
+        BOOST_REQUIRE( f >= 0.0f && f < 1.0f );
+        sum += f;
+        ++buckets[static_cast<int>(f * 10)];
+    }
+    BOOST_CHECK_CLOSE( sum / count, 0.5, 1.0 );
+    for (int b : buckets)
+    {
+        BOOST_CHECK_CLOSE( static_cast<double>(b), count / 10.0, 5.0 );
+    }
+}
+
+BOOST_AUTO_TEST_CASE(shapes)
+{
+    rng r(7u);
+    vec3 n = normalize(vec3(1, 2, 3));
+    vec3 sphereSum(0), hemisphereSum(0);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        BOOST_REQUIRE( length(r.disk()) <= 1.0f );
+
+        vec3 s = r.sphere();
+        BOOST_REQUIRE( std::abs(length(s) - 1.0f) < 1e-5f );
+        sphereSum += s;
+
+        vec3 h = r.hemisphere(n);
+        BOOST_REQUIRE( dot(h, n) >= 0.0f );
+        hemisphereSum += h;
+
+        BOOST_REQUIRE( dot(r.cosine_hemisphere(n), n) >= -1e-5f );
+    }
+
+    // sphere is centered, hemisphere leans towards the normal
+    BOOST_CHECK( length(sphereSum / 10000.0f) < 0.05f );
+    BOOST_CHECK( dot(normalize(hemisphereSum), n) > 0.99f );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
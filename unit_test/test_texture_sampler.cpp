@@ -0,0 +1,628 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+#include <swizzle/glsl/texture_sampler.h>
+#include <swizzle/glsl/texture_sampler_3d.h>
+#include <swizzle/glsl/texture_sampler_cube.h>
+#include <swizzle/glsl/texture_store.h>
+#include <cstdio>
+
+typedef swizzle::glsl::sampler2D<float> sampler2D;
+typedef swizzle::glsl::sampler3D<float> sampler3D;
+typedef swizzle::glsl::samplerCube<float> samplerCube;
+
+namespace
+{
+    inline bool are_colors_close(const vec4& a, const vec4& b)
+    {
+        return distance(a, b) < 1e-5f;
+    }
+
+    //! 2x2: red, green in the bottom row, blue, white in the top one.
+    const std::uint32_t texels_2x2[] = { 0xff0000ff, 0xff00ff00, 0xffff0000, 0xffffffff };
+
+    const vec4 red(1, 0, 0, 1), green(0, 1, 0, 1), blue(0, 0, 1, 1), white(1, 1, 1, 1);
+
+    inline vec4 packed_color(std::uint32_t rgba)
+    {
+        return unpackUnorm4x8(rgba);
+    }
+
+    inline vec4 rgba8(unsigned r, unsigned g, unsigned b, unsigned a = 255)
+    {
+        return packed_color(r | (g << 8) | (b << 16) | (a << 24));
+    }
+
+    //! Writes BC7 fields, least significant bit first.
+    struct bit_writer
+    {
+        std::uint8_t data[16];
+        unsigned position;
+
+        bit_writer()
+            : position(0)
+        {
+            std::fill(data, data + 16, 0);
+        }
+
+        void write(unsigned value, unsigned count)
+        {
+            for (unsigned i = 0; i < count; ++i, ++position)
+            {
+                data[position >> 3] |= ((value >> i) & 1) << (position & 7);
+            }
+        }
+    };
+
+    //! A single block texture, sampled texel by texel.
+    vec4 block_texel(sampler2D::texel_format format, const std::uint8_t* block, int x, int y)
+    {
+        sampler2D s(sampler2D::wrap_clamp, sampler2D::filter_nearest);
+        s.assign_compressed(4, 4, format, block);
+        return texelFetch(s, ivec2(x, y), 0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(TextureSampler)
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    sampler2D s;
+    BOOST_CHECK( s.sample(vec2(0.5f, 0.5f)) == vec4(0, 0, 0, 1) );
+    BOOST_CHECK( texture(s, vec2(0.5f, 0.5f)) == vec4(0, 0, 0, 1) );
+}
+
+BOOST_AUTO_TEST_CASE(nearest)
+{
+    sampler2D s(2, 2, texels_2x2, sampler2D::wrap_clamp, sampler2D::filter_nearest);
+    BOOST_CHECK( s.sample(vec2(0.25f, 0.25f)) == red );
+    BOOST_CHECK( s.sample(vec2(0.75f, 0.25f)) == green );
+    BOOST_CHECK( s.sample(vec2(0.25f, 0.75f)) == blue );
+    BOOST_CHECK( s.sample(vec2(0.75f, 0.75f)) == white );
+    BOOST_CHECK( texture(s, vec2(0.9f, 0.1f)) == green );
+}
+
+BOOST_AUTO_TEST_CASE(bilinear)
+{
+    sampler2D s(2, 2, texels_2x2, sampler2D::wrap_clamp);
+
+    // texel centres are exact
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.25f, 0.25f)), red) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.75f, 0.75f)), white) );
+
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.5f, 0.25f)), (red + green) * 0.5f) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.25f, 0.5f)), (red + blue) * 0.5f) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.5f, 0.5f)), (red + green + blue + white) * 0.25f) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.375f, 0.25f)), red * 0.75f + green * 0.25f) );
+}
+
+BOOST_AUTO_TEST_CASE(wrapping)
+{
+    sampler2D s(2, 2, texels_2x2, sampler2D::wrap_clamp);
+
+    // edges do not blend with the opposite side
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.0f, 0.25f)), red) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(-3.0f, 7.0f)), blue) );
+
+    s.wrap(sampler2D::wrap_repeat);
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.0f, 0.25f)), (red + green) * 0.5f) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(-0.75f, 3.25f)), red) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(1.75f, -0.25f)), white) );
+
+    s.wrap(sampler2D::wrap_mirror_repeat);
+    BOOST_CHECK( are_colors_close(s.sample(vec2(0.0f, 0.25f)), red) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(1.25f, 0.25f)), green) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(-0.25f, 0.25f)), red) );
+    BOOST_CHECK( are_colors_close(s.sample(vec2(2.25f, 0.75f)), blue) );
+
+    s.filter(sampler2D::filter_nearest);
+    BOOST_CHECK( s.sample(vec2(1.25f, 0.25f)) == green );
+    BOOST_CHECK( s.sample(vec2(-1.25f, -0.25f)) == green );
+}
+
+BOOST_AUTO_TEST_CASE(mipmaps)
+{
+    // 4x2: left half red, right half alternating green and blue rows
+    const std::uint32_t texels[] = { 0xff0000ff, 0xff0000ff, 0xff00ff00, 0xff00ff00, 0xff0000ff, 0xff0000ff, 0xffff0000, 0xffff0000 };
+    sampler2D s(4, 2, texels, sampler2D::wrap_clamp, sampler2D::filter_nearest);
+    BOOST_CHECK( s.levels() == 3 );
+
+    const vec2 right(0.75f, 0.25f);
+    const vec4 teal = packed_color(0xff808000);
+    BOOST_CHECK( textureLod(s, right, 0.0f) == green );
+    BOOST_CHECK( textureLod(s, right, 1.0f) == teal );
+    BOOST_CHECK( textureLod(s, right, 2.0f) == packed_color(0xff404080) );
+
+    // out of range LODs are clamped
+    BOOST_CHECK( textureLod(s, right, -5.0f) == green );
+    BOOST_CHECK( textureLod(s, right, 7.0f) == textureLod(s, right, 2.0f) );
+
+    s.mipmap(sampler2D::mipmap_nearest);
+    BOOST_CHECK( textureLod(s, right, 0.4f) == green );
+    BOOST_CHECK( textureLod(s, right, 0.6f) == teal );
+
+    s.mipmap(sampler2D::mipmap_linear);
+    BOOST_CHECK( are_colors_close(textureLod(s, right, 0.25f), green * 0.75f + teal * 0.25f) );
+
+    s.mipmap(sampler2D::mipmap_none);
+    BOOST_CHECK( textureLod(s, right, 1.0f) == green );
+
+    // without derivatives, texture samples the base level
+    s.mipmap(sampler2D::mipmap_linear);
+    BOOST_CHECK( texture(s, right) == green );
+}
+
+BOOST_AUTO_TEST_CASE(gradients)
+{
+    // black to white, so that each level blurs it differently
+    const std::uint32_t texels[] = { 0xff000000, 0xff000000, 0xff000000, 0xff000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
+    sampler2D s(8, 1, texels, sampler2D::wrap_clamp);
+    BOOST_CHECK( s.levels() == 4 );
+
+    const vec2 p(0.45f, 0.5f);
+    BOOST_CHECK( !are_colors_close(textureLod(s, p, 0.0f), textureLod(s, p, 1.0f)) );
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, vec2(1.0f / 8, 0), vec2(0, 0)), textureLod(s, p, 0.0f)) );
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, vec2(0, 0), vec2(2.0f / 8, 0)), textureLod(s, p, 1.0f)) );
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, vec2(4.0f / 8, 0), vec2(1.0f / 8, 0)), textureLod(s, p, 2.0f)) );
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, vec2(0, 0), vec2(0, 0)), textureLod(s, p, 0.0f)) );
+
+    // magnification stays at the base level
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, vec2(0.01f, 0), vec2(0, 0.01f)), textureLod(s, p, 0.0f)) );
+}
+
+BOOST_AUTO_TEST_CASE(anisotropy)
+{
+    // white and black rows: any level past the base one is grey
+    const size_t size = 32;
+    std::vector<std::uint32_t> texels(size * size);
+    for (size_t i = 0; i < texels.size(); ++i)
+    {
+        texels[i] = (i / size) % 2 ? 0xff000000 : 0xffffffff;
+    }
+    sampler2D s(size, size, texels.data(), sampler2D::wrap_repeat);
+    const vec4 grey = textureLod(s, vec2(0.5f, 0.5f), 1.0f);
+
+    // 8 texels along the rows, 1 across: a grazing angle
+    const vec2 p(0.3f, 2.5f / size), dx(8.0f / size, 0), dy(0, 1.0f / size);
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, dx, dy), grey) );
+
+    BOOST_CHECK( s.max_anisotropy() == 1.0f );
+    s.max_anisotropy(0.5f);
+    BOOST_CHECK( s.max_anisotropy() == 1.0f );
+
+    // 8 probes along the row keep it sharp, whichever gradient is the longer one
+    s.max_anisotropy(16.0f);
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, dx, dy), white) );
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, dy, dx), white) );
+    BOOST_CHECK( are_colors_close(textureGrad(s, p + vec2(0, 1.0f / size), dx, dy), vec4(0, 0, 0, 1)) );
+
+    // too few: the footprint still covers 8 texels, so it blurs at a finer level
+    s.max_anisotropy(2.5f);
+    BOOST_CHECK( are_colors_close(textureGrad(s, p, dx, dy), grey) );
+
+    // square footprints take a single probe, exactly like isotropic filtering
+    const vec2 q(0.37f, 0.61f);
+    sampler2D isotropic(size, size, texels.data(), sampler2D::wrap_repeat);
+    BOOST_CHECK( are_colors_close(textureGrad(s, q, vec2(3.0f / size, 0), vec2(0, 3.0f / size)), textureGrad(isotropic, q, vec2(3.0f / size, 0), vec2(0, 3.0f / size))) );
+    BOOST_CHECK( are_colors_close(textureGrad(s, q, vec2(0, 0), vec2(0, 0)), textureLod(isotropic, q, 0.0f)) );
+}
+
+BOOST_AUTO_TEST_CASE(layouts)
+{
+    // not a multiple of the tile size, so that partial tiles are covered, at every level too
+    const size_t width = 11, height = 6;
+    std::uint32_t texels[width * height];
+    for (size_t i = 0; i < width * height; ++i)
+    {
+        texels[i] = static_cast<std::uint32_t>(i * 2654435761u);
+    }
+
+    sampler2D linear(width, height, texels, sampler2D::wrap_repeat, sampler2D::filter_linear, sampler2D::mipmap_linear, sampler2D::layout_linear);
+    sampler2D tiled(width, height, texels, sampler2D::wrap_repeat, sampler2D::filter_linear, sampler2D::mipmap_linear, sampler2D::layout_tiled);
+    BOOST_CHECK( tiled.layout() == sampler2D::layout_tiled );
+    BOOST_CHECK( tiled.levels() == linear.levels() );
+
+    for (int y = -8; y < 20; ++y)
+    {
+        for (int x = -8; x < 30; ++x)
+        {
+            vec2 p(x * 0.07f, y * 0.11f);
+            float lod = (x + 8) * 0.1f;
+            BOOST_CHECK( textureLod(linear, p, lod) == textureLod(tiled, p, lod) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(formats)
+{
+    const size_t width = 7, height = 5;
+    std::uint32_t texels[width * height];
+    for (size_t i = 0; i < width * height; ++i)
+    {
+        texels[i] = static_cast<std::uint32_t>(i * 2654435761u);
+    }
+
+    const sampler2D::texel_format formats[] = { sampler2D::format_rgba16f, sampler2D::format_rgba16f_planar, sampler2D::format_rgba32f, sampler2D::format_rgba32f_planar };
+    const sampler2D::texel_layout layouts[] = { sampler2D::layout_linear, sampler2D::layout_tiled };
+
+    sampler2D reference(width, height, texels);
+    for (auto layout : layouts)
+    {
+        for (auto format : formats)
+        {
+            sampler2D s(width, height, texels, sampler2D::wrap_repeat, sampler2D::filter_linear, sampler2D::mipmap_linear, layout, format);
+            BOOST_CHECK( s.format() == format );
+            for (int i = 0; i < 50; ++i)
+            {
+                vec2 p(i * 0.137f - 2.0f, i * 0.071f - 1.0f);
+                // halves have 11 bits of precision; deeper levels of RGBA8 are rounded to 8 bits
+                BOOST_CHECK( distance(textureLod(s, p, 0.0f), textureLod(reference, p, 0.0f)) < 1e-3f );
+                BOOST_CHECK( distance(textureLod(s, p, 1.5f), textureLod(reference, p, 1.5f)) < 1e-2f );
+            }
+        }
+    }
+
+    // HDR values survive float formats only
+    const float hdr[] = { 4.0f, 0.5f, -1.0f, 1.0f };
+    sampler2D s(1, 1, hdr);
+    BOOST_CHECK( s.sample(vec2(0.5f)) == vec4(4.0f, 0.5f, -1.0f, 1.0f) );
+    s.assign(1, 1, hdr, sampler2D::layout_tiled, sampler2D::format_rgba16f_planar);
+    BOOST_CHECK( s.sample(vec2(0.5f)) == vec4(4.0f, 0.5f, -1.0f, 1.0f) );
+    s.assign(1, 1, hdr, sampler2D::layout_linear, sampler2D::format_rgba8);
+    BOOST_CHECK( s.sample(vec2(0.5f)) == vec4(1.0f, packed_color(0x80).x, 0.0f, 1.0f) );
+}
+
+BOOST_AUTO_TEST_CASE(texel_api)
+{
+    // 4x2: left half red, right half alternating green and blue rows
+    const std::uint32_t texels[] = { 0xff0000ff, 0xff0000ff, 0xff00ff00, 0xff00ff00, 0xff0000ff, 0xff0000ff, 0xffff0000, 0xffff0000 };
+    sampler2D s(4, 2, texels, sampler2D::wrap_repeat, sampler2D::filter_nearest);
+
+    BOOST_CHECK( textureSize(s, 0) == ivec2(4, 2) );
+    BOOST_CHECK( textureSize(s, 1) == ivec2(2, 1) );
+    BOOST_CHECK( textureSize(s, 2) == ivec2(1, 1) );
+    BOOST_CHECK( textureSize(s, 9) == ivec2(1, 1) );
+    BOOST_CHECK( textureSize(sampler2D(), 0) == ivec2(0, 0) );
+
+    BOOST_CHECK( texelFetch(s, ivec2(0, 0), 0) == red );
+    BOOST_CHECK( texelFetch(s, ivec2(3, 0), 0) == green );
+    BOOST_CHECK( texelFetch(s, ivec2(2, 1), 0) == blue );
+    BOOST_CHECK( texelFetch(s, ivec2(1, 0), 1) == packed_color(0xff808000) );
+    // out of range is clamped rather than read out of bounds
+    BOOST_CHECK( texelFetch(s, ivec2(10, -1), 0) == green );
+
+    // offsets are in texels and wrap
+    const vec2 p(0.125f, 0.25f);
+    BOOST_CHECK( textureOffset(s, p, ivec2(2, 0)) == green );
+    BOOST_CHECK( textureOffset(s, p, ivec2(-1, 1)) == blue );
+    BOOST_CHECK( textureOffset(s, p, ivec2(0, 0), 0.0f) == red );
+
+    // projection divides by the last component
+    BOOST_CHECK( textureProj(s, vec3(1.5f, 0.5f, 2.0f)) == s.sample(vec2(0.75f, 0.25f)) );
+    BOOST_CHECK( textureProj(s, vec4(0.75f, 1.5f, 7.0f, 2.0f)) == s.sample(vec2(0.375f, 0.75f)) );
+
+    // the 2x2 footprint of the centre of the texture, in GLSL's order
+    sampler2D q(2, 2, texels_2x2, sampler2D::wrap_clamp);
+    BOOST_CHECK( textureGather(q, vec2(0.5f, 0.5f)) == vec4(0, 1, 0, 1) );
+    BOOST_CHECK( textureGather(q, vec2(0.5f, 0.5f), 2) == vec4(1, 1, 0, 0) );
+    BOOST_CHECK( textureGather(q, vec2(0.5f, 0.5f), 3) == vec4(1) );
+    // sums to what bilinear filtering returns in the middle
+    BOOST_CHECK( std::abs(dot(textureGather(q, vec2(0.5f, 0.5f), 1), vec4(0.25f)) - texture(q, vec2(0.5f, 0.5f)).y) < 1e-5f );
+    BOOST_CHECK( textureGatherOffset(q, vec2(0.0f, 0.0f), ivec2(1, 1)) == textureGather(q, vec2(0.5f, 0.5f)) );
+}
+
+BOOST_AUTO_TEST_CASE(volumes)
+{
+    // 2x2x2: the 2x2 texture in the front slice, inverted colours in the back one
+    const std::uint32_t texels[] = { 0xff0000ff, 0xff00ff00, 0xffff0000, 0xffffffff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xff000000 };
+    const vec4 cyan(0, 1, 1, 1), black(0, 0, 0, 1);
+
+    sampler3D empty;
+    BOOST_CHECK( texture(empty, vec3(0.5f)) == vec4(0, 0, 0, 1) );
+
+    sampler3D s(2, 2, 2, texels, sampler3D::wrap_clamp, sampler3D::filter_nearest);
+    BOOST_CHECK( texture(s, vec3(0.25f, 0.25f, 0.25f)) == red );
+    BOOST_CHECK( texture(s, vec3(0.75f, 0.75f, 0.25f)) == white );
+    BOOST_CHECK( texture(s, vec3(0.25f, 0.25f, 0.75f)) == cyan );
+    BOOST_CHECK( texture(s, vec3(0.75f, 0.75f, 0.75f)) == black );
+    BOOST_CHECK( texelFetch(s, ivec3(1, 1, 1), 0) == black );
+    BOOST_CHECK( texelFetch(s, ivec3(-4, 9, 0), 0) == blue );
+    BOOST_CHECK( textureSize(s, 0) == ivec3(2, 2, 2) );
+
+    // trilinear: the middle is the average of all eight, i.e. grey, as the slices are complementary
+    s.filter(sampler3D::filter_linear);
+    BOOST_CHECK( are_colors_close(texture(s, vec3(0.5f)), vec4(0.5f, 0.5f, 0.5f, 1.0f)) );
+    BOOST_CHECK( are_colors_close(texture(s, vec3(0.25f, 0.25f, 0.5f)), (red + cyan) * 0.5f) );
+    BOOST_CHECK( are_colors_close(texture(s, vec3(0.25f, 0.25f, 0.375f)), red * 0.75f + cyan * 0.25f) );
+
+    s.wrap(sampler3D::wrap_repeat);
+    BOOST_CHECK( are_colors_close(texture(s, vec3(0.25f, 0.25f, 0.0f)), (red + cyan) * 0.5f) );
+    BOOST_CHECK( are_colors_close(texture(s, vec3(1.25f, -0.75f, 2.75f)), cyan) );
+
+    // bricked and linear storage sample the same, including partial bricks
+    const size_t width = 7, height = 5, depth = 6;
+    std::uint32_t volume[width * height * depth];
+    for (size_t i = 0; i < width * height * depth; ++i)
+    {
+        volume[i] = static_cast<std::uint32_t>(i * 2654435761u);
+    }
+    sampler3D linear(width, height, depth, volume, sampler3D::wrap_mirror_repeat, sampler3D::filter_linear, sampler3D::layout_linear);
+    sampler3D bricked(width, height, depth, volume, sampler3D::wrap_mirror_repeat, sampler3D::filter_linear, sampler3D::layout_bricked);
+    BOOST_CHECK( bricked.layout() == sampler3D::layout_bricked );
+    for (int i = 0; i < 200; ++i)
+    {
+        vec3 p(i * 0.037f - 2.0f, i * 0.051f - 3.0f, i * 0.023f - 1.0f);
+        BOOST_CHECK( texture(linear, p) == texture(bricked, p) );
+    }
+    BOOST_CHECK( texelFetch(bricked, ivec3(6, 4, 5), 0) == packed_color(volume[width * height * depth - 1]) );
+}
+
+BOOST_AUTO_TEST_CASE(cube_maps)
+{
+    // solid faces, except for +z, which is the 2x2 texture
+    const vec4 face_colors[] = { packed_color(0xff000001), packed_color(0xff000002), packed_color(0xff000003), packed_color(0xff000004), vec4(), packed_color(0xff000006) };
+    std::uint32_t faces[6 * 4];
+    for (size_t f = 0; f < 6; ++f)
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            faces[f * 4 + i] = f == samplerCube::face_positive_z ? texels_2x2[i] : 0xff000001u + static_cast<std::uint32_t>(f);
+        }
+    }
+
+    samplerCube empty;
+    BOOST_CHECK( texture(empty, vec3(1, 0, 0)) == vec4(0, 0, 0, 1) );
+
+    samplerCube s(2, faces, samplerCube::filter_nearest);
+    BOOST_CHECK( s.levels() == 2 );
+    BOOST_CHECK( textureSize(s, 0) == ivec2(2, 2) );
+    BOOST_CHECK( textureSize(s, 1) == ivec2(1, 1) );
+
+    BOOST_CHECK( texture(s, vec3(1, 0.2f, -0.3f)) == face_colors[0] );
+    BOOST_CHECK( texture(s, vec3(-2, 0.2f, -0.3f)) == face_colors[1] );
+    BOOST_CHECK( texture(s, vec3(0.1f, 0.5f, 0.2f)) == face_colors[2] );
+    BOOST_CHECK( texture(s, vec3(0.1f, -0.5f, 0.2f)) == face_colors[3] );
+    BOOST_CHECK( texture(s, vec3(0.1f, 0.5f, -0.7f)) == face_colors[5] );
+
+    // +z: s follows x, t follows -y
+    BOOST_CHECK( texture(s, vec3(-0.5f, 0.5f, 1)) == red );
+    BOOST_CHECK( texture(s, vec3(0.5f, 0.5f, 1)) == green );
+    BOOST_CHECK( texture(s, vec3(-0.5f, -0.5f, 1)) == blue );
+    BOOST_CHECK( texture(s, vec3(0.5f, -0.5f, 1)) == white );
+
+    // filtering stays within the face
+    s.filter(samplerCube::filter_linear);
+    BOOST_CHECK( are_colors_close(texture(s, vec3(0, 0, 1)), (red + green + blue + white) * 0.25f) );
+    BOOST_CHECK( are_colors_close(texture(s, vec3(-0.99f, 0.5f, 1)), red) );
+    BOOST_CHECK( are_colors_close(texture(s, vec3(1, 0.2f, -0.3f)), face_colors[0]) );
+
+    BOOST_CHECK( are_colors_close(textureLod(s, vec3(0.5f, -0.5f, 1), 1.0f), packed_color(0xff808080)) );
+    BOOST_CHECK( are_colors_close(textureLod(s, vec3(0.5f, -0.5f, 1), 0.5f), (white + packed_color(0xff808080)) * 0.5f) );
+}
+
+BOOST_AUTO_TEST_CASE(block_compression)
+{
+    // red and blue endpoints, column x uses index x
+    const std::uint8_t bc1[] = { 0x00, 0xf8, 0x1f, 0x00, 0xe4, 0xe4, 0xe4, 0xe4 };
+    BOOST_CHECK( block_texel(sampler2D::format_bc1, bc1, 0, 3) == red );
+    BOOST_CHECK( block_texel(sampler2D::format_bc1, bc1, 1, 2) == blue );
+    BOOST_CHECK( block_texel(sampler2D::format_bc1, bc1, 2, 1) == rgba8(170, 0, 85) );
+    BOOST_CHECK( block_texel(sampler2D::format_bc1, bc1, 3, 0) == rgba8(85, 0, 170) );
+
+    // c0 <= c1: three colours and transparent black
+    const std::uint8_t bc1a[] = { 0x1f, 0x00, 0x00, 0xf8, 0xe4, 0xe4, 0xe4, 0xe4 };
+    BOOST_CHECK( block_texel(sampler2D::format_bc1, bc1a, 2, 0) == rgba8(128, 0, 128) );
+    BOOST_CHECK( block_texel(sampler2D::format_bc1, bc1a, 3, 0) == vec4(0, 0, 0, 0) );
+
+    // 200 and 100 with eight values; texel i uses index i % 8
+    const std::uint8_t bc4[] = { 200, 100, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa };
+    BOOST_CHECK( block_texel(sampler2D::format_bc4, bc4, 0, 0) == rgba8(200, 0, 0) );
+    BOOST_CHECK( block_texel(sampler2D::format_bc4, bc4, 1, 2) == rgba8(100, 0, 0) );
+    BOOST_CHECK( block_texel(sampler2D::format_bc4, bc4, 2, 0) == rgba8(186, 0, 0) );
+    BOOST_CHECK( block_texel(sampler2D::format_bc4, bc4, 3, 1) == rgba8(114, 0, 0) );
+
+    // 10 and 20 with six values, 0 and 255
+    const std::uint8_t bc5[] = { 200, 100, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa, 10, 20, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa };
+    BOOST_CHECK( block_texel(sampler2D::format_bc5, bc5, 2, 0) == rgba8(186, 12, 0) );
+    BOOST_CHECK( block_texel(sampler2D::format_bc5, bc5, 2, 1) == rgba8(129, 0, 0) );
+    BOOST_CHECK( block_texel(sampler2D::format_bc5, bc5, 3, 1) == rgba8(114, 255, 0) );
+
+    // BC4 alpha with the colours of the BC1 block with c0 <= c1, which BC3 interpolates regardless
+    std::uint8_t bc3[16];
+    std::copy(bc4, bc4 + 8, bc3);
+    std::copy(bc1a, bc1a + 8, bc3 + 8);
+    BOOST_CHECK( block_texel(sampler2D::format_bc3, bc3, 0, 0) == rgba8(0, 0, 255, 200) );
+    BOOST_CHECK( block_texel(sampler2D::format_bc3, bc3, 3, 1) == rgba8(170, 0, 85, 114) );
+}
+
+BOOST_AUTO_TEST_CASE(block_compression_bc7)
+{
+    // mode 6: one subset, RGBA endpoints with p-bits, 4 bit indices
+    {
+        bit_writer w;
+        w.write(1 << 6, 7);
+        const unsigned endpoints[] = { 127, 0, 0, 127, 0, 0, 127, 127 };
+        for (unsigned e : endpoints)
+        {
+            w.write(e, 7);
+        }
+        w.write(1, 1);
+        w.write(1, 1);
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            w.write(i, i == 0 ? 3 : 4);
+        }
+        BOOST_CHECK( block_texel(sampler2D::format_bc7, w.data, 0, 0) == rgba8(255, 1, 1) );
+        BOOST_CHECK( block_texel(sampler2D::format_bc7, w.data, 0, 2) == rgba8(120, 136, 1) );
+        BOOST_CHECK( block_texel(sampler2D::format_bc7, w.data, 3, 3) == rgba8(1, 255, 1) );
+    }
+
+    // mode 5: rotation 1 swaps red and alpha
+    {
+        bit_writer w;
+        w.write(1 << 5, 6);
+        w.write(1, 2);
+        const unsigned endpoints[] = { 127, 127, 0, 0, 0, 0 };
+        for (unsigned e : endpoints)
+        {
+            w.write(e, 7);
+        }
+        w.write(0, 16);
+        BOOST_CHECK( block_texel(sampler2D::format_bc7, w.data, 1, 1) == rgba8(0, 0, 0, 255) );
+    }
+
+    // mode 1, partition 13: top two rows are the second subset
+    {
+        bit_writer w;
+        w.write(1 << 1, 2);
+        w.write(13, 6);
+        const unsigned reds[] = { 63, 63, 0, 0 };
+        for (unsigned e : reds)
+        {
+            w.write(e, 6);
+        }
+        BOOST_CHECK( block_texel(sampler2D::format_bc7, w.data, 2, 1) == rgba8(253, 0, 0) );
+        BOOST_CHECK( block_texel(sampler2D::format_bc7, w.data, 2, 2) == rgba8(0, 0, 0) );
+    }
+
+    // reserved mode
+    const std::uint8_t zeros[16] = {};
+    BOOST_CHECK( block_texel(sampler2D::format_bc7, zeros, 0, 0) == vec4(0, 0, 0, 0) );
+}
+
+BOOST_AUTO_TEST_CASE(block_compression_sampling)
+{
+    // 20x12 is 5x3 blocks, then 10x6 is 3x2 partial ones; the reference is the base level decoded up front
+    const size_t width = 20, height = 12, blocks_x = 5, blocks_y = 3;
+    std::uint8_t blocks[(blocks_x * blocks_y + 6) * 8];
+    for (size_t i = 0; i < sizeof(blocks); ++i)
+    {
+        blocks[i] = static_cast<std::uint8_t>((i * 2654435761u) >> 13);
+    }
+
+    std::uint32_t texels[width * height];
+    for (size_t b = 0; b < blocks_x * blocks_y; ++b)
+    {
+        std::uint32_t decoded[16];
+        swizzle::detail::block_compression::decode_bc1(blocks + b * 8, decoded);
+        for (size_t i = 0; i < 16; ++i)
+        {
+            texels[((b / blocks_x) * 4 + i / 4) * width + (b % blocks_x) * 4 + i % 4] = decoded[i];
+        }
+    }
+
+    sampler2D reference(width, height, texels, sampler2D::wrap_repeat);
+    sampler2D s(sampler2D::wrap_repeat);
+    s.assign_compressed(width, height, sampler2D::format_bc1, blocks, 2);
+    BOOST_CHECK( s.format() == sampler2D::format_bc1 );
+    BOOST_CHECK( s.levels() == 2 );
+    BOOST_CHECK( textureSize(s, 1) == ivec2(10, 6) );
+
+    for (int i = 0; i < 100; ++i)
+    {
+        vec2 p(i * 0.137f - 2.0f, i * 0.071f - 1.0f);
+        BOOST_CHECK( textureLod(s, p, 0.0f) == textureLod(reference, p, 0.0f) );
+        BOOST_CHECK( textureGather(s, p, 1) == textureGather(reference, p, 1) );
+    }
+
+    // the last block of the second level, partially used
+    std::uint32_t last[16];
+    swizzle::detail::block_compression::decode_bc1(blocks + (blocks_x * blocks_y + 5) * 8, last);
+    BOOST_CHECK( texelFetch(s, ivec2(9, 5), 1) == packed_color(last[5]) );
+
+    // BCn cannot be encoded, so assign falls back to RGBA8
+    sampler2D fallback(width, height, texels, sampler2D::wrap_repeat, sampler2D::filter_linear, sampler2D::mipmap_linear, sampler2D::layout_tiled, sampler2D::format_bc7);
+    BOOST_CHECK( fallback.format() == sampler2D::format_rgba8 );
+}
+
+BOOST_AUTO_TEST_CASE(mapped_textures)
+{
+    // 512x512 RGBA8 with its mips is 22 pages, four times the budget
+    const size_t size = 512;
+    std::vector<std::uint32_t> texels(size * size);
+    for (size_t i = 0; i < texels.size(); ++i)
+    {
+        texels[i] = static_cast<std::uint32_t>(i * 2654435761u);
+    }
+    const float rgba[] = { 0.5f, -2.0f, 1000.0f, 1.0f, 0.25f, 0.0f, 3.0f, 1.0f, 1.0f, 2.0f, 3.0f, 4.0f };
+    std::uint8_t blocks[3 * 8];
+    for (size_t i = 0; i < sizeof(blocks); ++i)
+    {
+        blocks[i] = static_cast<std::uint8_t>((i * 2654435761u) >> 13);
+    }
+
+    sampler2D reference(size, size, texels.data(), sampler2D::wrap_repeat, sampler2D::filter_linear, sampler2D::mipmap_linear, sampler2D::layout_tiled);
+    sampler2D hdr(3, 1, rgba, sampler2D::wrap_clamp, sampler2D::filter_linear, sampler2D::mipmap_linear, sampler2D::layout_linear, sampler2D::format_rgba32f_planar);
+    sampler2D compressed(sampler2D::wrap_clamp);
+    compressed.assign_compressed(12, 4, sampler2D::format_bc1, blocks);
+    BOOST_REQUIRE( reference.save("mapped_rgba8.tex") );
+    BOOST_REQUIRE( hdr.save("mapped_rgba32f.tex") );
+    BOOST_REQUIRE( compressed.save("mapped_bc1.tex") );
+    BOOST_CHECK( !sampler2D().save("mapped_empty.tex") );
+
+    {
+        swizzle::glsl::texture_store store(256 * 1024);
+        BOOST_CHECK( !store.open("mapped_missing.tex") );
+
+        sampler2D s(sampler2D::wrap_repeat);
+        BOOST_REQUIRE( s.assign_mapped(store.open("mapped_rgba8.tex")) );
+        BOOST_CHECK( s.width() == size && s.height() == size && s.levels() == reference.levels() );
+        BOOST_CHECK( s.layout() == sampler2D::layout_tiled );
+        BOOST_CHECK( store.resident() > 0 );
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            vec2 p(i * 0.0137f, i * 0.0071f);
+            float lod = static_cast<float>(i % 7) * 0.75f;
+            BOOST_CHECK( textureLod(s, p, lod) == textureLod(reference, p, lod) );
+            BOOST_CHECK( store.resident() <= store.budget() );
+        }
+        BOOST_CHECK( texelFetch(s, ivec2(511, 511), 0) == packed_color(texels.back()) );
+
+        // saving over a mapped file does not pull it from under the mapping
+        BOOST_REQUIRE( hdr.save("mapped_rgba8.tex") );
+        for (int i = 0; i < 200; ++i)
+        {
+            vec2 p(i * 0.0291f, i * 0.0113f);
+            BOOST_CHECK( textureLod(s, p, 0.0f) == textureLod(reference, p, 0.0f) );
+        }
+
+        sampler2D f(sampler2D::wrap_clamp);
+        BOOST_REQUIRE( f.assign_mapped(store.open("mapped_rgba32f.tex")) );
+        BOOST_CHECK( f.format() == sampler2D::format_rgba32f_planar );
+        BOOST_CHECK( texelFetch(f, ivec2(0, 0), 0) == vec4(0.5f, -2.0f, 1000.0f, 1.0f) );
+        BOOST_CHECK( texture(f, vec2(0.5f, 0.5f)) == texture(hdr, vec2(0.5f, 0.5f)) );
+
+        sampler2D c(sampler2D::wrap_clamp);
+        BOOST_REQUIRE( c.assign_mapped(store.open("mapped_bc1.tex")) );
+        BOOST_CHECK( c.format() == sampler2D::format_bc1 );
+        for (int x = 0; x < 12; ++x)
+        {
+            BOOST_CHECK( texelFetch(c, ivec2(x, 3), 0) == texelFetch(compressed, ivec2(x, 3), 0) );
+        }
+
+        // other files are rejected and leave the texture empty
+        BOOST_CHECK( !c.assign_mapped(store.open("mapped_rgba8.tex.missing")) );
+        BOOST_CHECK( texture(c, vec2(0.5f, 0.5f)) == vec4(0, 0, 0, 1) );
+        std::FILE* garbage = std::fopen("mapped_garbage.tex", "wb");
+        std::fwrite(texels.data(), 4, 64, garbage);
+        std::fclose(garbage);
+        BOOST_CHECK( !c.assign_mapped(store.open("mapped_garbage.tex")) );
+        BOOST_CHECK( c.width() == 0 && c.levels() == 0 );
+
+        // reassigning drops the mapping
+        s.assign(2, 2, texels_2x2);
+        f = sampler2D();
+        c = sampler2D();
+        BOOST_CHECK( store.resident() == 0 );
+    }
+
+    std::remove("mapped_rgba8.tex");
+    std::remove("mapped_rgba32f.tex");
+    std::remove("mapped_bc1.tex");
+    std::remove("mapped_garbage.tex");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,150 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include <swizzle/glsl/tile_scheduler.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using swizzle::glsl::tile_scheduler;
+
+BOOST_AUTO_TEST_SUITE(TileScheduler)
+
+BOOST_AUTO_TEST_CASE(covers_frame)
+{
+    // not a multiple of the tile size either way
+    const size_t width = 203, height = 77;
+    std::vector<std::atomic<int> > hits(width * height);
+    for (auto& h : hits)
+    {
+        h.store(0);
+    }
+
+    // draw runs on other threads too, where Boost.Test can not be used
+    tile_scheduler scheduler(32, 16);
+    std::atomic<size_t> bad_tiles(0);
+    const bool completed = scheduler.run(width, height, [&](const tile_scheduler::tile& t, size_t thread)
+    {
+        if (thread >= scheduler.stats().size() || !t.width || t.width > 32 || !t.height || t.height > 16)
+        {
+            bad_tiles.fetch_add(1);
+        }
+        for (size_t y = t.y; y < t.y + t.height; ++y)
+        {
+            for (size_t x = t.x; x < t.x + t.width; ++x)
+            {
+                hits[y * width + x].fetch_add(1);
+            }
+        }
+    });
+    BOOST_CHECK( completed );
+    BOOST_CHECK_EQUAL( bad_tiles.load(), 0u );
+
+    size_t wrong = 0;
+    for (auto& h : hits)
+    {
+        wrong += h.load() != 1;
+    }
+    BOOST_CHECK_EQUAL( wrong, 0u );
+
+    size_t tiles = 0;
+    for (const auto& s : scheduler.stats())
+    {
+        tiles += s.tiles;
+        BOOST_CHECK( s.busy_seconds >= 0 && s.busy_seconds <= scheduler.seconds() );
+    }
+    BOOST_CHECK_EQUAL( tiles, 7u * 5u );
+    BOOST_CHECK( scheduler.balance() > 0 && scheduler.balance() <= 1 );
+
+    // nothing to draw
+    bad_tiles.store(0);
+    BOOST_CHECK( scheduler.run(0, 10, [&](const tile_scheduler::tile&, size_t) { bad_tiles.fetch_add(1); }) );
+    BOOST_CHECK_EQUAL( bad_tiles.load(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE(stealing)
+{
+#ifdef _OPENMP
+    // a team of several threads even on a single core
+    const int max_threads = omp_get_max_threads();
+    const size_t team = 4;
+    omp_set_num_threads(static_cast<int>(team));
+
+    const size_t width = 203, height = 77;
+    std::vector<std::atomic<int> > hits(width * height);
+    tile_scheduler scheduler(8, 8);
+    const size_t count = 26 * 10;
+
+    // the top of the frame, where the first thread starts, is slow, so the others run out of their
+    // own tiles early and have to take some of its
+    size_t steals = 0, wrong = 0, tiles = 0, runs = 0;
+    for (; runs < 5; ++runs)
+    {
+        for (auto& h : hits)
+        {
+            h.store(0);
+        }
+
+        BOOST_CHECK( scheduler.run(width, height, [&](const tile_scheduler::tile& t, size_t)
+        {
+            if (t.y < height / 4)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            for (size_t y = t.y; y < t.y + t.height; ++y)
+            {
+                for (size_t x = t.x; x < t.x + t.width; ++x)
+                {
+                    hits[y * width + x].fetch_add(1);
+                }
+            }
+        }) );
+
+        for (auto& h : hits)
+        {
+            wrong += h.load() != 1;
+        }
+        for (const auto& s : scheduler.stats())
+        {
+            tiles += s.tiles;
+            steals += s.steals;
+        }
+    }
+    omp_set_num_threads(max_threads);
+
+    BOOST_CHECK_EQUAL( scheduler.stats().size(), team );
+    BOOST_CHECK_EQUAL( wrong, 0u );
+    BOOST_CHECK_EQUAL( tiles, count * runs );
+    BOOST_CHECK( steals > 0 );
+#else
+    BOOST_TEST_MESSAGE( "built without OpenMP, nothing to steal" );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(cancelling)
+{
+    tile_scheduler scheduler;
+    std::atomic<size_t> drawn(0);
+    const bool completed = scheduler.run(1024, 1024, [&](const tile_scheduler::tile&, size_t)
+    {
+        drawn.fetch_add(1);
+    },
+    [&]() { return drawn.load() >= 10; });
+
+    // each thread may be in the middle of a tile when it happens
+    BOOST_CHECK( !completed );
+    BOOST_CHECK( drawn.load() >= 10 && drawn.load() < 10 + scheduler.stats().size() );
+
+    // and the next run starts over
+    drawn.store(0);
+    BOOST_CHECK( scheduler.run(1024, 1024, [&](const tile_scheduler::tile&, size_t) { drawn.fetch_add(1); }) );
+    BOOST_CHECK_EQUAL( drawn.load(), 32u * 32u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+// CxxSwizzle
+// Copyright (c) 2013-2015, Piotr Gwiazdowski <gwiazdorrr+github at gmail.com>
+
+#include <boost/test/unit_test.hpp>
+#include <swizzle/glsl/triple_buffer.h>
+#include <thread>
+
+using swizzle::glsl::triple_buffer;
+
+namespace
+{
+    //! Large enough for a torn read to show.
+    struct frame
+    {
+        unsigned values[64];
+
+        frame()
+        {
+            fill(0);
+        }
+
+        void fill(unsigned value)
+        {
+            for (auto& v : values)
+            {
+                v = value;
+            }
+        }
+
+        bool consistent() const
+        {
+            for (auto v : values)
+            {
+                if (v != values[0])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+}
+
+BOOST_AUTO_TEST_SUITE(TripleBuffer)
+
+BOOST_AUTO_TEST_CASE(handoff)
+{
+    triple_buffer<int> buffer;
+    BOOST_CHECK( !buffer.update() );
+    BOOST_CHECK_EQUAL( buffer.front(), 0 );
+
+    buffer.back() = 1;
+    buffer.publish();
+    BOOST_CHECK( buffer.update() );
+    BOOST_CHECK_EQUAL( buffer.front(), 1 );
+
+    // taken only once
+    BOOST_CHECK( !buffer.update() );
+    BOOST_CHECK_EQUAL( buffer.front(), 1 );
+
+    // the writer never waits, the reader gets the latest
+    for (int i = 2; i <= 5; ++i)
+    {
+        buffer.back() = i;
+        buffer.publish();
+        BOOST_CHECK( buffer.back() != 1 );
+    }
+    BOOST_CHECK( buffer.update() );
+    BOOST_CHECK_EQUAL( buffer.front(), 5 );
+    BOOST_CHECK( !buffer.update() );
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+    const unsigned count = 100000;
+    triple_buffer<frame> buffer;
+
+    // no Boost.Test on the writer's thread
+    std::thread writer([&]()
+    {
+        for (unsigned i = 1; i <= count; ++i)
+        {
+            buffer.back().fill(i);
+            buffer.publish();
+        }
+    });
+
+    unsigned last = 0, torn = 0, backwards = 0;
+    while (last < count)
+    {
+        if (buffer.update())
+        {
+            const frame& f = buffer.front();
+            torn += !f.consistent();
+            backwards += f.values[0] <= last;
+            last = f.values[0];
+        }
+    }
+    writer.join();
+
+    BOOST_CHECK_EQUAL( torn, 0u );
+    BOOST_CHECK_EQUAL( backwards, 0u );
+    BOOST_CHECK( !buffer.update() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()